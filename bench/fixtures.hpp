@@ -0,0 +1,44 @@
+#ifndef FIXTURES_HPP
+#define FIXTURES_HPP
+
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include "intro.hpp"
+
+namespace fixtures {
+
+  inline intro::Bar make_bar(int64_t i) {
+    return {i % 2 == 0,
+            i * 1000003,
+            i % 3 == 0 ? boost::none
+                       : boost::make_optional("bar #" + std::to_string(i))};
+  }
+
+  inline intro::Foo make_foo(int32_t i) {
+    return {i % 2 == 0,
+            i,
+            int64_t{i} * 1000000007,
+            static_cast<uint32_t>(i) * 2654435761u,
+            uint64_t{static_cast<uint32_t>(i)} << 33,
+            i * 0.1,
+            static_cast<float>(i) / 3,
+            intro::FooInfo::X,
+            "foo #" + std::to_string(i),
+            {i, i + 1, i + 2, i + 3},
+            {"hello", "world"},
+            i,
+            boost::none,
+            int64_t{i} << 20,
+            std::make_unique<int32_t>(i),
+            nullptr,
+            make_bar(i)};
+  }
+
+}  // namespace fixtures
+
+#endif  // FIXTURES_HPP
@@ -0,0 +1,180 @@
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <jpc.hpp>
+
+#include "fixtures.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace intro;
+
+namespace {
+
+  /* A `Writer` that forwards every token to a `std::ostream`, the way the
+     serializers used to. Kept here as the baseline. */
+
+  class ostream_writer {
+    public:
+    explicit ostream_writer(std::ostream &strm) : strm_(strm) {}
+
+    void put(char c) { strm_ << c; }
+
+    void write(const char *s, std::size_t n) {
+      strm_.write(s, static_cast<std::streamsize>(n));
+    }
+
+    template <std::size_t N>
+    void write(const char (&s)[N]) {
+      strm_ << s;
+    }
+
+    char *prepare(std::size_t) { return block_; }
+
+    void commit(char *last) { write(block_, static_cast<std::size_t>(last - block_)); }
+
+    private:
+    std::ostream &strm_;
+    char block_[64];
+  };
+
+  template <typename Schema, typename T>
+  void per_token_ostream(benchmark::State &state, const Schema &schema, const T &value) {
+    std::ostringstream strm;
+    for (auto _ : state) {
+      strm.str({});
+      ostream_writer writer(strm);
+      schema.json(value).write(writer);
+      benchmark::DoNotOptimize(strm);
+    }  // for
+  }
+
+  template <typename Schema, typename T>
+  void ostream_adapter(benchmark::State &state, const Schema &schema, const T &value) {
+    std::ostringstream strm;
+    for (auto _ : state) {
+      strm.str({});
+      strm << schema.json(value);
+      benchmark::DoNotOptimize(strm);
+    }  // for
+  }
+
+  template <typename Schema, typename T>
+  void buffer(benchmark::State &state, const Schema &schema, const T &value) {
+    jpc::buffer buffer;
+    for (auto _ : state) {
+      buffer.clear();
+      schema.json(value).write(buffer);
+      benchmark::DoNotOptimize(buffer.data());
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+  }
+
+  template <typename Schema, typename T>
+  void to_string(benchmark::State &state, const Schema &schema, const T &value) {
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(jpc::to_string(schema.json(value)));
+    }  // for
+  }
+
+  void BM_Bar(benchmark::State &state,
+              void (*run)(benchmark::State &, const decltype(Bar::full()) &, const Bar &)) {
+    run(state, Bar::full(), fixtures::make_bar(42));
+  }
+
+  void BM_Foo(benchmark::State &state,
+              void (*run)(benchmark::State &, const decltype(Foo::full()) &, const Foo &)) {
+    run(state, Foo::full(), fixtures::make_foo(42));
+  }
+
+  const std::vector<Bar> &bars() {
+    static const std::vector<Bar> bars = [] {
+      std::vector<Bar> result;
+      result.reserve(1000000);
+      for (int64_t i = 0; i < 1000000; ++i) {
+        result.push_back(fixtures::make_bar(i));
+      }  // for
+      return result;
+    }();
+    return bars;
+  }
+
+  /* One `to_string` per record, appended to the output. */
+  void BM_json_lines_to_string(benchmark::State &state) {
+    std::string out;
+    for (auto _ : state) {
+      out.clear();
+      for (const Bar &bar : bars()) {
+        out += jpc::to_string(Bar::full().json(bar));
+        out += '\n';
+      }  // for
+      benchmark::DoNotOptimize(out.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * bars().size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * out.size()));
+  }
+
+  void BM_json_lines_buffer(benchmark::State &state) {
+    jpc::buffer buffer;
+    for (auto _ : state) {
+      buffer.clear();
+      jpc::json_lines(Bar::full(), bars().begin(), bars().end(), buffer);
+      benchmark::DoNotOptimize(buffer.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * bars().size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+  }
+
+  void BM_json_lines_sink(benchmark::State &state) {
+    std::size_t size = 0;
+    for (auto _ : state) {
+      size = 0;
+      jpc::json_lines(Bar::full(), bars().begin(), bars().end(),
+                      [&](const char *s, std::size_t n) {
+                        benchmark::DoNotOptimize(s);
+                        size += n;
+                      });
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * bars().size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * size));
+  }
+
+  /* A 1M-element array of `Bar` on 1..N threads. */
+  void BM_parallel_array(benchmark::State &state) {
+    const auto schema = jpc::array(Bar::full());
+    const jpc::parallel policy(static_cast<std::size_t>(state.range(0)));
+    jpc::buffer buffer;
+    for (auto _ : state) {
+      buffer.clear();
+      schema.json(bars()).write(buffer, policy);
+      benchmark::DoNotOptimize(buffer.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * bars().size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+  }
+
+}  // namespace
+
+BENCHMARK(BM_parallel_array)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_json_lines_to_string)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_json_lines_buffer)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_json_lines_sink)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_CAPTURE(BM_Bar, per_token_ostream, per_token_ostream);
+BENCHMARK_CAPTURE(BM_Bar, ostream_adapter, ostream_adapter);
+BENCHMARK_CAPTURE(BM_Bar, buffer, buffer);
+BENCHMARK_CAPTURE(BM_Bar, to_string, to_string);
+
+BENCHMARK_CAPTURE(BM_Foo, per_token_ostream, per_token_ostream);
+BENCHMARK_CAPTURE(BM_Foo, ostream_adapter, ostream_adapter);
+BENCHMARK_CAPTURE(BM_Foo, buffer, buffer);
+BENCHMARK_CAPTURE(BM_Foo, to_string, to_string);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,107 @@
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include <jpc.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+  template <typename T>
+  std::vector<T> doubles(std::size_t n) {
+    std::mt19937_64 gen(42);
+    std::uniform_real_distribution<double> dist(-1e6, 1e6);
+    std::vector<T> result;
+    for (std::size_t i = 0; i < n; ++i) {
+      result.push_back(static_cast<T>(dist(gen)));
+    }  // for
+    return result;
+  }
+
+  template <typename T>
+  void BM_ostream(benchmark::State &state, std::vector<T> values) {
+    std::ostringstream strm;
+    for (auto _ : state) {
+      strm.str({});
+      for (T value : values) {
+        strm << value << ',';
+      }  // for
+      benchmark::DoNotOptimize(strm);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * values.size()));
+  }
+
+  template <typename T>
+  void BM_snprintf(benchmark::State &state, std::vector<T> values, const char *fmt) {
+    jpc::buffer buffer;
+    for (auto _ : state) {
+      buffer.clear();
+      for (T value : values) {
+        char *first = buffer.prepare(32);
+        buffer.commit(first + std::snprintf(first, 32, fmt, value));
+        buffer.put(',');
+      }  // for
+      benchmark::DoNotOptimize(buffer.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * values.size()));
+  }
+
+  template <typename T>
+  void BM_jpc(benchmark::State &state, std::vector<T> values) {
+    jpc::buffer buffer;
+    for (auto _ : state) {
+      buffer.clear();
+      for (T value : values) {
+        jpc::number.json(value).write(buffer);
+        buffer.put(',');
+      }  // for
+      benchmark::DoNotOptimize(buffer.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * values.size()));
+  }
+
+  template <typename T>
+  std::vector<T> integers(std::size_t n) {
+    // IDs and counters: log-uniform over the magnitude of `T`.
+    std::mt19937_64 gen(42);
+    std::vector<T> result;
+    for (std::size_t i = 0; i < n; ++i) {
+      uint64_t bits = gen() >> (gen() % 64);
+      result.push_back(static_cast<T>(bits));
+    }  // for
+    return result;
+  }
+
+}  // namespace
+
+// `ostream` and `%g` keep 6 significant digits; `%.17g` round-trips.
+BENCHMARK_CAPTURE(BM_ostream, double, doubles<double>(1000));
+BENCHMARK_CAPTURE(BM_snprintf, double_g, doubles<double>(1000), "%g");
+BENCHMARK_CAPTURE(BM_snprintf, double_17g, doubles<double>(1000), "%.17g");
+BENCHMARK_CAPTURE(BM_jpc, double, doubles<double>(1000));
+
+BENCHMARK_CAPTURE(BM_ostream, float, doubles<float>(1000));
+BENCHMARK_CAPTURE(BM_snprintf, float_9g, doubles<float>(1000), "%.9g");
+BENCHMARK_CAPTURE(BM_jpc, float, doubles<float>(1000));
+
+BENCHMARK_CAPTURE(BM_ostream, int32, integers<int32_t>(1000));
+BENCHMARK_CAPTURE(BM_snprintf, int32, integers<int32_t>(1000), "%d");
+BENCHMARK_CAPTURE(BM_jpc, int32, integers<int32_t>(1000));
+
+BENCHMARK_CAPTURE(BM_ostream, uint32, integers<uint32_t>(1000));
+BENCHMARK_CAPTURE(BM_snprintf, uint32, integers<uint32_t>(1000), "%u");
+BENCHMARK_CAPTURE(BM_jpc, uint32, integers<uint32_t>(1000));
+
+BENCHMARK_CAPTURE(BM_ostream, int64, integers<int64_t>(1000));
+BENCHMARK_CAPTURE(BM_snprintf, int64, integers<int64_t>(1000), "%" PRId64);
+BENCHMARK_CAPTURE(BM_jpc, int64, integers<int64_t>(1000));
+
+BENCHMARK_CAPTURE(BM_ostream, uint64, integers<uint64_t>(1000));
+BENCHMARK_CAPTURE(BM_snprintf, uint64, integers<uint64_t>(1000), "%" PRIu64);
+BENCHMARK_CAPTURE(BM_jpc, uint64, integers<uint64_t>(1000));
+
+BENCHMARK_MAIN();
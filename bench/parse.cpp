@@ -0,0 +1,502 @@
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/utility/string_view.hpp>
+
+#include <jpc.hpp>
+
+#include <google/protobuf/util/json_util.h>
+
+#include "fixtures.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace intro;
+
+namespace {
+
+  /* `Foo` JSON parsed back into a `Foo`. */
+  void BM_from_json_Foo(benchmark::State &state) {
+    const std::string text =
+        jpc::to_string(Foo::full().json(fixtures::make_foo(42)));
+    Foo foo = fixtures::make_foo(0);
+    for (auto _ : state) {
+      Foo::assignable().from_json(text, foo);
+      benchmark::DoNotOptimize(foo);
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* The checks of `BM_from_json_Foo` alone, keeping nothing. */
+  void BM_validate_json_Foo(benchmark::State &state) {
+    const std::string text =
+        jpc::to_string(Foo::full().json(fixtures::make_foo(42)));
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(Foo::full().validate_json(text));
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* `Foo` to JSON and back. */
+  void BM_round_trip_Foo(benchmark::State &state) {
+    const Foo original = fixtures::make_foo(42);
+    Foo foo = fixtures::make_foo(0);
+    jpc::buffer buffer;
+    for (auto _ : state) {
+      buffer.clear();
+      Foo::full().json(original).write(buffer);
+      Foo::assignable().from_json(buffer.data(), buffer.data() + buffer.size(), foo);
+      benchmark::DoNotOptimize(foo);
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+  }
+
+  /* `Foo` JSON parsed straight into a `FooInfo`. */
+  void BM_json_to_protobuf_Foo(benchmark::State &state) {
+    const std::string text =
+        jpc::to_string(Foo::full().json(fixtures::make_foo(42)));
+    for (auto _ : state) {
+      FooInfo info = Foo::full().json_to_protobuf(text);
+      benchmark::DoNotOptimize(info);
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* The same, setting `FooInfo` through its generated accessors. */
+  void BM_json_to_protobuf_Foo_generated(benchmark::State &state) {
+    const std::string text =
+        jpc::to_string(Foo::full().json(fixtures::make_foo(42)));
+    for (auto _ : state) {
+      FooInfo info = Foo::generated().json_to_protobuf(text);
+      benchmark::DoNotOptimize(info);
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* The same through protobuf's own reflective JSON parser. */
+  void BM_JsonStringToMessage_Foo(benchmark::State &state) {
+    const std::string text =
+        jpc::to_string(Foo::full().json(fixtures::make_foo(42)));
+    for (auto _ : state) {
+      FooInfo info;
+      if (!google::protobuf::util::JsonStringToMessage(text, &info).ok()) {
+        state.SkipWithError("JsonStringToMessage failed");
+        break;
+      }  // if
+      benchmark::DoNotOptimize(info);
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* Objects of `N` `int32_t` fields named "key_000", "key_001", ...: one
+     length and one prefix, the worst case for a length-then-first-bytes
+     switch. */
+
+  template <std::size_t N>
+  struct Wide {
+    std::array<int32_t, N> values;
+  };
+
+  template <std::size_t I>
+  struct name {
+    static constexpr char value[] = {
+        'k', 'e', 'y', '_', '0' + I / 100, '0' + I / 10 % 10, '0' + I % 10, '\0'};
+  };
+
+  template <std::size_t I>
+  constexpr char name<I>::value[];
+
+  template <std::size_t I>
+  struct element {
+    template <typename Wide>
+    auto &operator()(Wide &wide) const { return wide.values[I]; }
+  };
+
+  template <std::size_t N, std::size_t... Is>
+  const auto &wide(std::index_sequence<Is...>) {
+    static const auto schema = jpc::object<Wide<N>, google::protobuf::Message>(
+        jpc::field(jpc::number, element<Is>{}, name<Is>::value)...);
+    return schema;
+  }
+
+  template <std::size_t N>
+  const auto &wide() {
+    return wide<N>(std::make_index_sequence<N>{});
+  }
+
+  /* The keys of `wide<N>()`, looked up in reverse order. */
+  template <std::size_t N>
+  std::vector<std::string> wide_keys() {
+    std::vector<std::string> result;
+    for (std::size_t i = N; i-- > 0;) {
+      char key[8];
+      std::snprintf(key, sizeof(key), "key_%03zu", i);
+      result.push_back(key);
+    }  // for
+    return result;
+  }
+
+  /* The linear compare chain the perfect hash replaced. */
+  template <std::size_t N>
+  void BM_key_linear(benchmark::State &state) {
+    const std::vector<std::string> keys = wide_keys<N>();
+    std::vector<std::string> names = keys;
+    for (auto _ : state) {
+      for (const std::string &key : keys) {
+        std::size_t index = 0;
+        while (index < names.size() &&
+               !(names[index].size() == key.size() &&
+                 std::memcmp(names[index].data(), key.data(), key.size()) == 0)) {
+          ++index;
+        }  // while
+        benchmark::DoNotOptimize(index);
+      }  // for
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * N));
+  }
+
+  template <std::size_t N>
+  void BM_key_perfect_hash(benchmark::State &state) {
+    const std::vector<std::string> keys = wide_keys<N>();
+    std::vector<std::pair<const char *, std::size_t>> names;
+    for (const std::string &key : keys) {
+      names.emplace_back(key.data(), key.size());
+    }  // for
+    jpc::detail::perfect_hash hash(names);
+    for (auto _ : state) {
+      for (const std::string &key : keys) {
+        benchmark::DoNotOptimize(hash.find(key.data(), key.size()));
+      }  // for
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * N));
+  }
+
+  template <std::size_t N>
+  void BM_from_json_wide(benchmark::State &state) {
+    Wide<N> value{};
+    for (std::size_t i = 0; i < N; ++i) {
+      value.values[i] = static_cast<int32_t>(i * 7919);
+    }  // for
+    const std::string text = jpc::to_string(wide<N>().json(value));
+    for (auto _ : state) {
+      wide<N>().from_json(text, value);
+      benchmark::DoNotOptimize(value);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * N));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* 100k `Bar`s in one object, about 5 MB compact. */
+
+  struct Batch {
+    std::vector<Bar> bars;
+  };
+
+  const auto &batch() {
+    static const auto schema = jpc::object<Batch, google::protobuf::Message>(
+        jpc::field(jpc::array(Bar::full()), &Batch::bars, "bars"));
+    return schema;
+  }
+
+  const std::string &batch_json(bool pretty) {
+    static const std::string compact = [] {
+      Batch value;
+      for (int64_t i = 0; i < 100000; ++i) {
+        value.bars.push_back(fixtures::make_bar(i));
+      }  // for
+      return jpc::to_string(batch().json(value));
+    }();
+    // The fixture strings hold no `{`, `,` or `:`.
+    static const std::string indented = [] {
+      std::string result;
+      for (char c : compact) {
+        result += c;
+        if (c == '{' || c == '[' || c == ',') {
+          result += "\n        ";
+        } else if (c == ':') {
+          result += ' ';
+        }  // if
+      }  // for
+      return result;
+    }();
+    return pretty ? indented : compact;
+  }
+
+  /* Argument: pretty. */
+  void BM_from_json_batch(benchmark::State &state) {
+    const std::string &text = batch_json(state.range(0));
+    Batch value;
+    for (auto _ : state) {
+      batch().from_json(text, value);
+      benchmark::DoNotOptimize(value);
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* The 100k `Bar`s as a top-level array, pushed in chunks of the
+     argument's size; 0 reads it whole with `read_json` instead. */
+  void BM_push_parser_array(benchmark::State &state) {
+    static const auto schema = jpc::array(Bar::full());
+    const std::string &compact = batch_json(false);
+    const std::string text = compact.substr(8, compact.size() - 9);
+    const auto chunk = static_cast<std::size_t>(state.range(0));
+    std::vector<Bar> value;
+    for (auto _ : state) {
+      if (chunk == 0) {
+        jpc::detail::reader reader(text.data(), text.data() + text.size());
+        schema.read_json(reader, value);
+        reader.finish();
+      } else {
+        auto parser = schema.parser(value);
+        for (std::size_t i = 0; i < text.size(); i += chunk) {
+          parser.feed(text.data() + i,
+                      text.data() + std::min(i + chunk, text.size()));
+        }  // for
+        parser.finish();
+      }  // if
+      benchmark::DoNotOptimize(value.data());
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* 1M `Bar`s, one per line, on 1..N threads. */
+  void BM_parse_json_lines(benchmark::State &state) {
+    static const std::string text = [] {
+      std::vector<Bar> bars;
+      for (int64_t i = 0; i < 1000000; ++i) {
+        bars.push_back(fixtures::make_bar(i));
+      }  // for
+      std::string result;
+      jpc::string_writer writer(result);
+      jpc::json_lines(Bar::full(), bars.begin(), bars.end(), writer);
+      return result;
+    }();
+    const jpc::parallel policy(static_cast<std::size_t>(state.range(0)));
+    std::vector<Bar> value;
+    for (auto _ : state) {
+      jpc::parse_json_lines(Bar::full(), text, value, policy);
+      benchmark::DoNotOptimize(value.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * value.size()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* 100k random doubles, as `dtoa` writes them. */
+  const std::string &doubles_json() {
+    static const std::string text = [] {
+      std::mt19937_64 gen(42);
+      std::uniform_real_distribution<double> dist(-1e6, 1e6);
+      std::vector<double> values;
+      for (int i = 0; i < 100000; ++i) {
+        values.push_back(i % 2 ? dist(gen) : dist(gen) * 1e-200);
+      }  // for
+      return jpc::to_string(jpc::array(jpc::number).json(values));
+    }();
+    return text;
+  }
+
+  void BM_read_doubles(benchmark::State &state) {
+    const std::string &text = doubles_json();
+    const auto schema = jpc::array(jpc::number);
+    std::vector<double> value;
+    for (auto _ : state) {
+      jpc::detail::reader reader(text.data(), text.data() + text.size());
+      schema.read_json(reader, value);
+      reader.finish();
+      benchmark::DoNotOptimize(value.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * value.size()));
+  }
+
+  /* The same numbers through `strtod`, as the reader used to. */
+  void BM_strtod_doubles(benchmark::State &state) {
+    const std::string &text = doubles_json();
+    std::vector<double> value;
+    for (auto _ : state) {
+      value.clear();
+      const char *p = text.c_str() + 1;
+      while (*p != '\0') {
+        char *end;
+        value.push_back(std::strtod(p, &end));
+        p = end + 1;
+      }  // while
+      benchmark::DoNotOptimize(value.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations() * value.size()));
+  }
+
+  /* Records of 50 keys, of which the schema declares 3. */
+
+  struct Record {
+    int64_t id;
+    std::string name;
+    double score;
+  };
+
+  const auto &record() {
+    static const auto schema = jpc::object<Record, google::protobuf::Message>(
+        jpc::field(jpc::number, &Record::id, "id"),
+        jpc::field(jpc::string, &Record::name, "name"),
+        jpc::field(jpc::number, &Record::score, "score"));
+    return schema;
+  }
+
+  std::string record_json(int i) {
+    std::string result = "{";
+    for (int k = 0; k < 47; ++k) {
+      std::string key = "\"extra_" + std::to_string(k) + "\":";
+      switch (k % 4) {
+        case 0: result += key + std::to_string(i * k) + ','; break;
+        case 1: result += key + "\"some \\\"quoted\\\" text\","; break;
+        case 2: result += key + R"({"a":[1,2,3],"b":{"c":"}"}},)"; break;
+        case 3: result += key + R"([true,false,null,"x",[{}]],)"; break;
+      }  // switch
+      if (k == 10) {
+        result += R"("id":)" + std::to_string(i) + ',';
+      } else if (k == 20) {
+        result += R"("name":"record )" + std::to_string(i) + "\",";
+      } else if (k == 30) {
+        result += R"("score":)" + std::to_string(i) + ".5,";
+      }  // if
+    }  // for
+    result.back() = '}';
+    return result;
+  }
+
+  void BM_from_json_sparse(benchmark::State &state) {
+    const std::string text = record_json(42);
+    Record value;
+    std::size_t skipped = 0;
+    for (auto _ : state) {
+      skipped = record().from_json(text, value).skipped;
+      benchmark::DoNotOptimize(value);
+    }  // for
+    state.counters["skipped"] = static_cast<double>(skipped);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* 10k sparse records in one array. */
+  void BM_from_json_sparse_batch(benchmark::State &state) {
+    static const auto schema = jpc::array(record());
+    static const std::string text = [] {
+      std::string result = "[";
+      for (int i = 0; i < 10000; ++i) {
+        result += record_json(i) + ',';
+      }  // for
+      result.back() = ']';
+      return result;
+    }();
+    std::vector<Record> value;
+    for (auto _ : state) {
+      jpc::detail::reader reader(text.data(), text.data() + text.size());
+      schema.read_json(reader, value);
+      reader.finish();
+      benchmark::DoNotOptimize(value.data());
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * text.size()));
+  }
+
+  /* Log lines of 4 string fields, owned or viewed. */
+
+  template <typename String>
+  struct Line {
+    String host;
+    String path;
+    String agent;
+    String message;
+  };
+
+  template <typename String, typename Schema>
+  const auto &line(Schema schema) {
+    static const auto result = jpc::object<Line<String>, google::protobuf::Message>(
+        jpc::field(schema, &Line<String>::host, "host"),
+        jpc::field(schema, &Line<String>::path, "path"),
+        jpc::field(schema, &Line<String>::agent, "agent"),
+        jpc::field(schema, &Line<String>::message, "message"));
+    return result;
+  }
+
+  const std::string line_json =
+      R"({"host":"api-17.eu-west.internal.example.com",)"
+      R"("path":"/v2/accounts/8431/transactions?since=2024-01-01&limit=500",)"
+      R"("agent":"Mozilla/5.0 X11; Linux x86_64; rv:121.0 Gecko/20100101 Firefox/121.0",)"
+      R"("message":"request served from the regional cache after revalidation with the origin"})";
+
+  void BM_from_json_string(benchmark::State &state) {
+    const auto &schema = line<std::string>(jpc::string);
+    Line<std::string> value;
+    for (auto _ : state) {
+      // A fresh object each time, as when parsing a stream of them.
+      value = {};
+      schema.from_json(line_json, value);
+      benchmark::DoNotOptimize(value);
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * line_json.size()));
+  }
+
+  void BM_from_json_string_view(benchmark::State &state) {
+    const auto &schema = line<boost::string_view>(jpc::string_view);
+    Line<boost::string_view> value;
+    for (auto _ : state) {
+      value = {};
+      schema.from_json(line_json, value);
+      benchmark::DoNotOptimize(value);
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * line_json.size()));
+  }
+
+  void BM_validate_json_string(benchmark::State &state) {
+    const auto &schema = line<std::string>(jpc::string);
+    for (auto _ : state) {
+      benchmark::DoNotOptimize(schema.validate_json(line_json));
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * line_json.size()));
+  }
+
+}  // namespace
+
+BENCHMARK(BM_from_json_string);
+BENCHMARK(BM_from_json_string_view);
+BENCHMARK(BM_validate_json_string);
+
+BENCHMARK(BM_from_json_sparse);
+BENCHMARK(BM_from_json_sparse_batch)->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_from_json_batch)->Arg(0)->Arg(1)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_read_doubles);
+BENCHMARK(BM_strtod_doubles);
+
+BENCHMARK(BM_parse_json_lines)
+    ->RangeMultiplier(2)
+    ->Range(1, 16)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK(BM_push_parser_array)
+    ->Arg(0)->Arg(1460)->Arg(65536)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_TEMPLATE(BM_key_linear, 5);
+BENCHMARK_TEMPLATE(BM_key_linear, 20);
+BENCHMARK_TEMPLATE(BM_key_linear, 100);
+BENCHMARK_TEMPLATE(BM_key_perfect_hash, 5);
+BENCHMARK_TEMPLATE(BM_key_perfect_hash, 20);
+BENCHMARK_TEMPLATE(BM_key_perfect_hash, 100);
+BENCHMARK_TEMPLATE(BM_from_json_wide, 5);
+BENCHMARK_TEMPLATE(BM_from_json_wide, 20);
+BENCHMARK_TEMPLATE(BM_from_json_wide, 100);
+
+BENCHMARK(BM_from_json_Foo);
+BENCHMARK(BM_validate_json_Foo);
+BENCHMARK(BM_round_trip_Foo);
+BENCHMARK(BM_json_to_protobuf_Foo);
+BENCHMARK(BM_json_to_protobuf_Foo_generated);
+BENCHMARK(BM_JsonStringToMessage_Foo);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,164 @@
+#include <cstdint>
+#include <string>
+
+#include <jpc.hpp>
+
+#include "fixtures.hpp"
+#include "nested.hpp"
+
+#include <benchmark/benchmark.h>
+
+using namespace intro;
+
+namespace {
+
+  /* `Foo` to a `FooInfo`, items are conversions. */
+  void BM_protobuf_Foo(benchmark::State &state) {
+    const Foo foo = fixtures::make_foo(42);
+    for (auto _ : state) {
+      FooInfo info = Foo::full().protobuf(foo);
+      benchmark::DoNotOptimize(info);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  }
+
+  /* The same through the generated accessors instead of reflection. */
+  void BM_protobuf_Foo_generated(benchmark::State &state) {
+    const Foo foo = fixtures::make_foo(42);
+    for (auto _ : state) {
+      FooInfo info = Foo::generated().protobuf(foo);
+      benchmark::DoNotOptimize(info);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  }
+
+  void BM_protobuf_Bar(benchmark::State &state) {
+    const Bar bar = fixtures::make_bar(42);
+    for (auto _ : state) {
+      BarInfo info = Bar::full().protobuf(bar);
+      benchmark::DoNotOptimize(info);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  }
+
+  void BM_protobuf_Bar_generated(benchmark::State &state) {
+    const Bar bar = fixtures::make_bar(42);
+    for (auto _ : state) {
+      BarInfo info = Bar::generated().protobuf(bar);
+      benchmark::DoNotOptimize(info);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  }
+
+  /* `Foo` to wire bytes through a `FooInfo`, as before `protobuf_bytes`;
+     bytes are the encoded size. */
+  void BM_SerializeToString_Foo(benchmark::State &state) {
+    const Foo foo = fixtures::make_foo(42);
+    std::string bytes;
+    for (auto _ : state) {
+      Foo::generated().protobuf(foo).SerializeToString(&bytes);
+      benchmark::DoNotOptimize(bytes);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+  }
+
+  /* `Foo` straight to wire bytes, into a reused buffer. */
+  void BM_protobuf_bytes_Foo(benchmark::State &state) {
+    const Foo foo = fixtures::make_foo(42);
+    jpc::buffer buffer;
+    for (auto _ : state) {
+      buffer.clear();
+      Foo::full().protobuf_bytes(foo, buffer);
+      benchmark::DoNotOptimize(buffer.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+  }
+
+  /* Into a new string each time. */
+  void BM_protobuf_bytes_Foo_string(benchmark::State &state) {
+    const Foo foo = fixtures::make_foo(42);
+    std::string bytes;
+    for (auto _ : state) {
+      bytes = Foo::full().protobuf_bytes(foo);
+      benchmark::DoNotOptimize(bytes);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+  }
+
+  /* 8 `Baz`s of 8 `Foo`s each: every `Bar` is three messages down, and
+     each message's length is written before its fields. */
+  void BM_protobuf_bytes_Qux(benchmark::State &state) {
+    Qux qux;
+    for (int i = 0; i < 8; ++i) {
+      Baz baz;
+      for (int j = 0; j < 8; ++j) {
+        baz.foos_.push_back(fixtures::make_foo(i * 8 + j));
+      }  // for
+      qux.bazs_.push_back(std::move(baz));
+    }  // for
+    jpc::buffer buffer;
+    for (auto _ : state) {
+      buffer.clear();
+      Qux::full().protobuf_bytes(qux, buffer);
+      benchmark::DoNotOptimize(buffer.data());
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * buffer.size()));
+  }
+
+  /* Wire bytes to a `FooInfo`, the first half of the way to a `Foo`
+     before `from_protobuf_bytes`. */
+  void BM_ParseFromString_Foo(benchmark::State &state) {
+    const std::string bytes = Foo::full().protobuf_bytes(fixtures::make_foo(42));
+    FooInfo info;
+    for (auto _ : state) {
+      info.ParseFromString(bytes);
+      benchmark::DoNotOptimize(info);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+  }
+
+  /* Wire bytes straight to a `Foo`, reused. */
+  void BM_from_protobuf_bytes_Foo(benchmark::State &state) {
+    const std::string bytes = Foo::full().protobuf_bytes(fixtures::make_foo(42));
+    Foo foo = fixtures::make_foo(0);
+    for (auto _ : state) {
+      Foo::assignable().from_protobuf_bytes(bytes, foo);
+      benchmark::DoNotOptimize(foo);
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes.size()));
+  }
+
+  /* The by-name lookups a conversion of `Foo` used to make. */
+  void BM_FindFieldByName_Foo(benchmark::State &state) {
+    const auto *descriptor = FooInfo::descriptor();
+    const char *names[] = {"a", "b", "c", "d", "e", "f", "g", "h", "i",
+                           "j", "k", "l", "m", "n", "o", "p", "bar"};
+    for (auto _ : state) {
+      for (const char *name : names) {
+        benchmark::DoNotOptimize(descriptor->FindFieldByName(name));
+      }  // for
+    }  // for
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+  }
+
+}  // namespace
+
+BENCHMARK(BM_FindFieldByName_Foo);
+BENCHMARK(BM_ParseFromString_Foo);
+BENCHMARK(BM_SerializeToString_Foo);
+BENCHMARK(BM_from_protobuf_bytes_Foo);
+BENCHMARK(BM_protobuf_Bar);
+BENCHMARK(BM_protobuf_Bar_generated);
+BENCHMARK(BM_protobuf_Foo);
+BENCHMARK(BM_protobuf_Foo_generated);
+BENCHMARK(BM_protobuf_bytes_Foo);
+BENCHMARK(BM_protobuf_bytes_Foo_string);
+BENCHMARK(BM_protobuf_bytes_Qux);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,101 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include <jpc.hpp>
+
+#include <benchmark/benchmark.h>
+
+namespace {
+
+  /* Mostly clean ASCII of 20-200 bytes; one in `dirty` has a quote. */
+  std::vector<std::string> strings(std::size_t n, std::size_t dirty) {
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<std::size_t> length(20, 200);
+    std::uniform_int_distribution<int> printable(0x20, 0x7E);
+    std::vector<std::string> result;
+    for (std::size_t i = 0; i < n; ++i) {
+      std::string str(length(gen), ' ');
+      for (char &c : str) {
+        do {
+          c = static_cast<char>(printable(gen));
+        } while (c == '"' || c == '\\');
+      }  // for
+      if (dirty && i % dirty == 0) {
+        str[str.size() / 2] = '"';
+      }  // if
+      result.push_back(std::move(str));
+    }  // for
+    return result;
+  }
+
+  template <typename Write>
+  void run(benchmark::State &state, const std::vector<std::string> &values, Write write) {
+    jpc::buffer buffer;
+    std::size_t bytes = 0;
+    for (const auto &value : values) {
+      bytes += value.size();
+    }  // for
+    for (auto _ : state) {
+      buffer.clear();
+      for (const auto &value : values) {
+        write(buffer, value);
+      }  // for
+      benchmark::DoNotOptimize(buffer.data());
+    }  // for
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+  }
+
+  void BM_per_char(benchmark::State &state, std::size_t dirty) {
+    run(state, strings(1000, dirty), [](jpc::buffer &buffer, const std::string &value) {
+      buffer.put('"');
+      for (char c : value) {
+        if (jpc::detail::escape::needs_escape(static_cast<unsigned char>(c))) {
+          jpc::detail::escape::write_escape(buffer, static_cast<unsigned char>(c));
+        } else {
+          buffer.put(c);
+        }  // if
+      }  // for
+      buffer.put('"');
+    });
+  }
+
+  void BM_scanner(benchmark::State &state,
+                  jpc::detail::escape::find_fn find,
+                  std::size_t dirty) {
+    run(state, strings(1000, dirty), [find](jpc::buffer &buffer, const std::string &value) {
+      buffer.put('"');
+      const char *first = value.data(), *last = first + value.size();
+      for (;;) {
+        const char *p = find(first, last);
+        buffer.write(first, static_cast<std::size_t>(p - first));
+        if (p == last) {
+          break;
+        }  // if
+        jpc::detail::escape::write_escape(buffer, static_cast<unsigned char>(*p));
+        first = p + 1;
+      }  // for
+      buffer.put('"');
+    });
+  }
+
+  void BM_jpc(benchmark::State &state, std::size_t dirty) {
+    run(state, strings(1000, dirty), [](jpc::buffer &buffer, const std::string &value) {
+      jpc::string.json(value).write(buffer);
+    });
+  }
+
+}  // namespace
+
+BENCHMARK_CAPTURE(BM_per_char, clean, 0);
+BENCHMARK_CAPTURE(BM_scanner, scalar_clean, jpc::detail::escape::find_scalar, 0);
+#if JPC_X86
+BENCHMARK_CAPTURE(BM_scanner, sse2_clean, jpc::detail::escape::find_sse2, 0);
+BENCHMARK_CAPTURE(BM_scanner, avx2_clean, jpc::detail::escape::find_avx2, 0);
+#endif
+BENCHMARK_CAPTURE(BM_jpc, clean, 0);
+
+BENCHMARK_CAPTURE(BM_per_char, dirty, 4);
+BENCHMARK_CAPTURE(BM_jpc, dirty, 4);
+
+BENCHMARK_MAIN();
@@ -1,16 +1,39 @@
 #ifndef JPC_HPP
 #define JPC_HPP
 
+#include <algorithm>
+#include <array>
+#include <bitset>
 #include <cassert>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <initializer_list>
 #include <iterator>
+#include <limits>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <jpc/detail/apply.hpp>
+#include <jpc/detail/atof.hpp>
+#include <jpc/detail/dtoa.hpp>
+#include <jpc/detail/escape.hpp>
 #include <jpc/detail/invoke.hpp>
+#include <jpc/detail/itoa.hpp>
+#include <jpc/detail/parallel.hpp>
+#include <jpc/detail/perfect_hash.hpp>
+#include <jpc/detail/push_parser.hpp>
+#include <jpc/detail/reader.hpp>
+#include <jpc/detail/wire.hpp>
+#include <jpc/detail/writer.hpp>
 
+#include <boost/optional.hpp>
+
+#include <google/protobuf/io/coded_stream.h>
 #include <google/protobuf/message.h>
 
 #include <meta/meta.hpp>
@@ -33,19 +56,55 @@ namespace jpc {
     class enumeration;
     class number;
     class string;
+    class string_view;
 
     template <typename Schema>
     class array;
 
-    template <typename F, typename Schema>
+    /* The accessor of a field that is set through reflection. */
+    struct reflective {};
+
+    template <typename Schema,
+              typename F,
+              std::size_t Length,
+              typename Accessor = reflective>
     class field;
 
     template <typename Schema>
     class optional;
 
+    template <typename Schema>
+    struct is_optional : std::false_type {};
+
+    template <typename Schema>
+    struct is_optional<optional<Schema>> : std::true_type {};
+
+    /* Schemas of scalars, which a repeated field may pack. */
+    template <typename Schema>
+    struct is_packable : std::false_type {};
+
+    template <>
+    struct is_packable<boolean> : std::true_type {};
+
+    template <>
+    struct is_packable<enumeration> : std::true_type {};
+
+    template <>
+    struct is_packable<number> : std::true_type {};
+
     template <typename Object, typename Message, typename... Fields>
     class object;
 
+    template <typename T, typename Schema>
+    class push_parser;
+
+    template <typename F, typename Object>
+    using member_t = std::decay_t<decltype(
+        detail::invoke(std::declval<F>(), std::declval<const Object &>()))>;
+
+    template <typename Schema, typename T = void, typename E = void>
+    struct MaxJsonSize;
+
     #define RETURN(...) -> decltype(__VA_ARGS__) { return __VA_ARGS__; }
 
     namespace adl {
@@ -66,24 +125,78 @@ namespace jpc {
       template <typename T, typename Schema>
       class string;
 
+      /* scalar formatting. */
+
+#define FORMAT(type)                                \
+  template <typename Writer>                        \
+  void write_number(Writer &writer, type value) {   \
+    char *first = writer.prepare(itoa::max_length); \
+    writer.commit(itoa::to_chars(first, value));    \
+  }
+      FORMAT(int32_t)
+      FORMAT(int64_t)
+      FORMAT(uint32_t)
+      FORMAT(uint64_t)
+#undef FORMAT
+
+      inline std::size_t number_size(int32_t value) { return itoa::size(value); }
+      inline std::size_t number_size(int64_t value) { return itoa::size(value); }
+      inline std::size_t number_size(uint32_t value) { return itoa::size(value); }
+      inline std::size_t number_size(uint64_t value) { return itoa::size(value); }
+
+      /* JSON has no NaN or infinities; like `JSON.stringify`, they are
+         written as `null`. */
+
+#define FORMAT(type)                                \
+  template <typename Writer>                        \
+  void write_number(Writer &writer, type value) {   \
+    if (!std::isfinite(value)) {                    \
+      writer.write("null");                         \
+      return;                                       \
+    }                                               \
+    char *first = writer.prepare(dtoa::max_length); \
+    writer.commit(dtoa::to_chars(first, value));    \
+  }
+      FORMAT(double)
+      FORMAT(float)
+#undef FORMAT
+
+      /* Shortest digits have no cheaper bound than producing them. */
+
+#define SIZE(type)                                          \
+  inline std::size_t number_size(type value) {              \
+    if (!std::isfinite(value)) {                            \
+      return 4;                                             \
+    }                                                       \
+    char first[dtoa::max_length];                           \
+    char *last = dtoa::to_chars(first, value);              \
+    return static_cast<std::size_t>(last - first);          \
+  }
+      SIZE(double)
+      SIZE(float)
+#undef SIZE
+
       template <>
       class string<bool, boolean> {
         public:
         bool value_;
 
+        template <typename Writer>
+        void write(Writer &writer) const {
+          if (value_) {
+            writer.write("true");
+          } else {
+            writer.write("false");
+          }  // if
+        }
+
+        std::size_t size() const { return value_ ? 4 : 5; }
+
         private:
         string(const string &) = default;
         string(string &&) = default;
 
         friend class boolean;
-
-        friend std::ostream &operator<<(std::ostream &strm,
-                                        const string &that) {
-          std::ios_base::fmtflags flags = strm.setf(std::ios_base::boolalpha);
-          strm << that.value_;
-          strm.flags(flags);
-          return strm;
-        }
       };
 
       template <typename Enum>
@@ -93,16 +206,28 @@ namespace jpc {
 
         Enum value_;
 
+        template <typename Writer>
+        void write(Writer &writer) const {
+          using Underlying = std::underlying_type_t<Enum>;
+          using Integral = std::conditional_t<std::is_signed<Underlying>{},
+                                              int64_t,
+                                              uint64_t>;
+          write_number(writer, static_cast<Integral>(value_));
+        }
+
+        std::size_t size() const {
+          using Underlying = std::underlying_type_t<Enum>;
+          using Integral = std::conditional_t<std::is_signed<Underlying>{},
+                                              int64_t,
+                                              uint64_t>;
+          return number_size(static_cast<Integral>(value_));
+        }
+
         private:
         string(const string &) = default;
         string(string &&) = default;
 
         friend class enumeration;
-
-        friend std::ostream &operator<<(std::ostream &strm,
-                                        const string &that) {
-          return strm << that.value_;
-        }
       };
 
       template <typename Arithmetic>
@@ -112,16 +237,18 @@ namespace jpc {
 
         Arithmetic value_;
 
+        template <typename Writer>
+        void write(Writer &writer) const {
+          write_number(writer, value_);
+        }
+
+        std::size_t size() const { return number_size(value_); }
+
         private:
         string(const string &) = default;
         string(string &&) = default;
 
         friend class number;
-
-        friend std::ostream &operator<<(std::ostream &strm,
-                                        const string &that) {
-          return strm << that.value_;
-        }
       };
 
       template <>
@@ -129,16 +256,45 @@ namespace jpc {
         public:
         const std::string &value_;
 
+        template <typename Writer>
+        void write(Writer &writer) const {
+          writer.put('"');
+          escape::write(writer, value_.data(), value_.data() + value_.size());
+          writer.put('"');
+        }
+
+        std::size_t size() const {
+          return 2 + escape::size(value_.data(), value_.data() + value_.size());
+        }
+
         private:
         string(const string &) = default;
         string(string &&) = default;
 
         friend class detail::string;
+      };
+
+      template <typename View>
+      class string<View, detail::string_view> {
+        public:
+        const View &value_;
+
+        template <typename Writer>
+        void write(Writer &writer) const {
+          writer.put('"');
+          escape::write(writer, value_.data(), value_.data() + value_.size());
+          writer.put('"');
+        }
 
-        friend std::ostream &operator<<(std::ostream &strm,
-                                        const string &that) {
-          return strm << '"' << that.value_ << '"';
+        std::size_t size() const {
+          return 2 + escape::size(value_.data(), value_.data() + value_.size());
         }
+
+        private:
+        string(const string &) = default;
+        string(string &&) = default;
+
+        friend class detail::string_view;
       };
 
       template <typename Iter, typename Schema>
@@ -146,48 +302,95 @@ namespace jpc {
         public:
         Iter begin_;
         Iter end_;
-        Schema schema_;
+        const Schema &schema_;
+
+        template <typename Writer>
+        void write(Writer &writer) const {
+          writer.put('[');
+          if (begin_ != end_) {
+            auto iter = begin_;
+            schema_.json(*iter++).write(writer);
+            while (iter != end_) {
+              writer.put(',');
+              schema_.json(*iter++).write(writer);
+            }  // while
+          }  // if
+          writer.put(']');
+        }
+
+        /* Cuts a random-access range into tasks that are serialized
+           concurrently into buffers of their own, then writes the buffers
+           out in order. The output is identical to `write(writer)`; with an
+           `fd_writer` the buffers go out uncopied, in one `writev`. */
+        template <typename Writer>
+        void write(Writer &writer, const parallel &policy) const {
+          static_assert(
+              std::is_base_of<std::random_access_iterator_tag,
+                              typename std::iterator_traits<
+                                  Iter>::iterator_category>{},
+              "parallel serialization needs a random-access range");
+          const auto n = static_cast<std::size_t>(end_ - begin_);
+          const std::size_t tasks = policy.tasks(n);
+          if (tasks <= 1) {
+            write(writer);
+            return;
+          }  // if
+          std::vector<buffer> buffers(tasks);
+          parallel_for(tasks, policy, [&](std::size_t i) {
+            auto first = begin_ + static_cast<std::ptrdiff_t>(i * n / tasks);
+            auto last = begin_ + static_cast<std::ptrdiff_t>((i + 1) * n / tasks);
+            buffer &out = buffers[i];
+            for (auto iter = first; iter != last; ++iter) {
+              if (iter != begin_) {
+                out.put(',');
+              }  // if
+              schema_.json(*iter).write(out);
+            }  // for
+          });
+          writer.put('[');
+          writer.write_all(buffers);
+          writer.put(']');
+        }
+
+        std::size_t size() const {
+          std::size_t result = 2;
+          for (auto iter = begin_; iter != end_; ++iter) {
+            result += schema_.json(*iter).size() + 1;
+          }  // for
+          return begin_ == end_ ? result : result - 1;
+        }
 
         private:
         string(const string &) = default;
         string(string &&) = default;
 
         friend class array<Schema>;
-
-        friend std::ostream &operator<<(std::ostream &strm,
-                                        const string &that) {
-          strm << '[';
-          if (that.begin_ != that.end_) {
-            auto iter = that.begin_;
-            strm << that.schema_.json(*iter++);
-            while (iter != that.end_) {
-              strm << ',' << that.schema_.json(*iter++);
-            }
-          }  // for
-          strm << ']';
-          return strm;
-        }
       };
 
       template <typename Optional, typename Schema>
       class string<Optional, optional<Schema>> {
         public:
         const Optional &value_;
-        Schema schema_;
+        const Schema &schema_;
+
+        template <typename Writer>
+        void write(Writer &writer) const {
+          if (!value_) {
+            writer.write("null");
+            return;
+          }  // if
+          schema_.json(*value_).write(writer);
+        }
+
+        std::size_t size() const {
+          return value_ ? schema_.json(*value_).size() : 4;
+        }
 
         private:
         string(const string &) = default;
         string(string &&) = default;
 
         friend class optional<Schema>;
-
-        friend std::ostream &operator<<(std::ostream &strm,
-                                        const string &that) {
-          if (!that.value_) {
-            return strm << "null";
-          }
-          return strm << that.schema_.json(*that.value_);
-        }
       };
 
       template <typename Object,
@@ -196,33 +399,67 @@ namespace jpc {
       class string<Object, object<Object, Message, Fields...>> {
         public:
         const Object &value_;
-        std::tuple<Fields...> fields_;
-
-        private:
-        string(const string &) = default;
-        string(string &&) = default;
+        const std::tuple<Fields...> &fields_;
 
-        friend class object<Object, Message, Fields...>;
+        template <typename Writer>
+        void write(Writer &writer) const {
+          writer.put('{');
+          detail::apply(
+              [&](const auto &field, const auto &... fields) {
+                field.json_object(writer, value_, true);
+                int for_each[] = {[&] {
+                  fields.json_object(writer, value_, false);
+                  return 0;
+                }()...};
+                (void)for_each;
+              },
+              fields_);
+          writer.put('}');
+        }
 
-        friend std::ostream &operator<<(std::ostream &strm,
-                                        const string &that) {
-          strm << '{';
+        std::size_t size() const {
+          std::size_t result = 2;
           detail::apply(
               [&](const auto &field, const auto &... fields) {
-                field.json_object(strm, that.value_);
+                result += field.json_object_size(value_, true);
                 int for_each[] = {[&] {
-                  strm << ',';
-                  fields.json_object(strm, that.value_);
+                  result += fields.json_object_size(value_, false);
                   return 0;
                 }()...};
                 (void)for_each;
               },
-              that.fields_);
-          strm << '}';
-          return strm;
+              fields_);
+          return result;
+        }
+
+        private:
+        string(const string &) = default;
+        string(string &&) = default;
+
+        friend class object<Object, Message, Fields...>;
+      };
+
+      /* `std::ostream` adapter.
+
+         Renders into a stack block and hands it to the stream in one
+         `write`, rather than paying for a sentry per brace and number. */
+
+      struct ostream_sink {
+        void operator()(const char *s, std::size_t n) const {
+          strm_->write(s, static_cast<std::streamsize>(n));
         }
+
+        std::ostream *strm_;
       };
 
+      template <typename T, typename Schema>
+      std::ostream &operator<<(std::ostream &strm,
+                               const string<T, Schema> &that) {
+        sink_writer<ostream_sink, 1024> writer(ostream_sink{&strm});
+        that.write(writer);
+        return strm;
+      }
+
     }  // namespace json
 
     namespace protobuf {
@@ -238,6 +475,18 @@ namespace jpc {
       template <typename T>
       struct is_message : std::is_convertible<T *, Message *> {};
 
+      /* is_swappable: `Swap` hands the contents over, without copying
+         unless the two are on different arenas. */
+
+      template <typename T>
+      struct is_swappable : is_message<T> {};
+
+      template <typename T>
+      struct is_swappable<RepeatedField<T>> : std::true_type {};
+
+      template <typename T>
+      struct is_swappable<RepeatedPtrField<T>> : std::true_type {};
+
       /* cpp_type */
 
       template <typename T, typename E = void>
@@ -339,27 +588,105 @@ namespace jpc {
         return TypeCheck<T>{}(field_descriptor);
       }
 
-      /* set_elem */
+      /* How `field_descriptor`'s values are laid out on the wire. */
+      inline wire::field wire_field(const FieldDescriptor *field_descriptor) {
+        wire::encoding encoding;
+        switch (field_descriptor->type()) {
+          case FieldDescriptor::TYPE_SINT32:
+          case FieldDescriptor::TYPE_SINT64:
+            encoding = wire::encoding::zigzag;
+            break;
+          case FieldDescriptor::TYPE_FIXED32:
+          case FieldDescriptor::TYPE_SFIXED32:
+          case FieldDescriptor::TYPE_FLOAT:
+            encoding = wire::encoding::fixed32;
+            break;
+          case FieldDescriptor::TYPE_FIXED64:
+          case FieldDescriptor::TYPE_SFIXED64:
+          case FieldDescriptor::TYPE_DOUBLE:
+            encoding = wire::encoding::fixed64;
+            break;
+          case FieldDescriptor::TYPE_STRING:
+          case FieldDescriptor::TYPE_BYTES:
+          case FieldDescriptor::TYPE_MESSAGE:
+            encoding = wire::encoding::length_delimited;
+            break;
+          default:
+            encoding = wire::encoding::varint;
+            break;
+        }  // switch
+        return wire::make_field(static_cast<uint32_t>(field_descriptor->number()),
+                                encoding,
+                                field_descriptor->is_packed());
+      }
+
+      /* set_elem: moves `value` into `elem`, e.g. one just `Add`ed. */
 
       template <typename T>
-      meta::if_<is_message<T>,
+      meta::if_<is_swappable<T>,
       void> set_elem(T *elem, meta::id_t<T> &&value) {
-        elem->CopyFrom(std::move(value));
+        elem->Swap(&value);
       }
 
       template <typename T>
-      meta::if_<meta::not_<is_message<T>>,
+      meta::if_<meta::not_<is_swappable<T>>,
       void> set_elem(T *elem, meta::id_t<T> &&value) {
         *elem = std::move(value);
       }
 
+      /* set_generated: `set_field` through a generated accessor of `M`
+         instead of reflection, i.e. a plain call with no lookups. Scalars
+         and enums take a setter such as `&FooInfo::set_b`; strings,
+         messages and repeated fields a `mutable_` one such as
+         `&FooInfo::mutable_bar`. */
+
+      template <typename M, typename Accessor>
+      struct set_generated;
+
+      template <typename M, typename Arg>
+      struct set_generated<M, void (M::*)(Arg)> {
+        void operator()(Arg value) const { (message_->*setter_)(std::move(value)); }
+
+        template <typename T>
+        void operator()(boost::optional<T> &&value) const {
+          if (value) {
+            (*this)(*std::move(value));
+          }  // if
+        }
+
+        M *message_;
+        void (M::*setter_)(Arg);
+      };  // set_generated
+
+      template <typename M, typename Field>
+      struct set_generated<M, Field *(M::*)()> {
+        void operator()(Field &&value) const {
+          set_elem((message_->*mutable_)(), std::move(value));
+        }
+
+        template <typename T>
+        void operator()(boost::optional<T> &&value) const {
+          if (value) {
+            (*this)(*std::move(value));
+          }  // if
+        }
+
+        M *message_;
+        Field *(M::*mutable_)();
+      };  // set_generated
+
       /* set_field */
 
       struct set_field {
         set_field(Message *message, const FieldDescriptor *field_descriptor)
+            : set_field(message, field_descriptor, message->GetReflection()) {}
+
+        set_field(Message *message,
+                  const FieldDescriptor *field_descriptor,
+                  const Reflection *reflection)
             : message_(message),
               field_descriptor_(field_descriptor),
-              reflection_(message_->GetReflection()) {}
+              reflection_(reflection) {}
 
 #define OP(Type, type)                                                     \
   void operator()(type value) const {                                      \
@@ -391,26 +718,30 @@ namespace jpc {
           }  // if
         }
 
+        /* Swapped into the sub-message, unless that is of another type,
+           e.g. a dynamic message. */
         template <typename Message>
         meta::if_<is_message<Message>,
         void> operator()(Message &&value) const {
           auto *message =
               reflection_->MutableMessage(message_, field_descriptor_);
-          message->CopyFrom(std::move(value));
+          if (message->GetReflection() == value.GetReflection()) {
+            set_elem(static_cast<Message *>(message), std::move(value));
+          } else {
+            message->CopyFrom(value);
+          }  // if
         }
 
         template <typename T>
         void operator()(RepeatedField<T> &&value) const {
-          auto *repeated =
-              reflection_->MutableRepeatedField<T>(message_, field_descriptor_);
-          repeated->CopyFrom(std::move(value));
+          set_elem(reflection_->MutableRepeatedField<T>(message_, field_descriptor_),
+                   std::move(value));
         }
 
         template <typename T>
         void operator()(RepeatedPtrField<T> &&value) const {
-          auto *repeated = reflection_->MutableRepeatedPtrField<T>(
-              message_, field_descriptor_);
-          repeated->CopyFrom(std::move(value));
+          set_elem(reflection_->MutableRepeatedPtrField<T>(message_, field_descriptor_),
+                   std::move(value));
         }
 
         private:
@@ -426,7 +757,39 @@ namespace jpc {
     class boolean {
       public:
       json::string<bool, boolean> json(bool value) const { return {value}; }
+      std::size_t json_size(bool value) const { return json(value).size(); }
       bool protobuf(bool value) const { return value; }
+
+      uint64_t wire_bits(wire::encoding encoding, bool value) const {
+        return wire::bits(encoding, value);
+      }
+
+      std::size_t wire_size(const wire::field &field, bool value, wire::sizes &) const {
+        return wire::scalar_size(field, wire_bits(field.encoding, value));
+      }
+
+      template <typename Writer>
+      void write_wire(Writer &writer,
+                      const wire::field &field,
+                      bool value,
+                      wire::sizes &) const {
+        wire::write_scalar(writer, field, wire_bits(field.encoding, value));
+      }
+
+      void read_wire(wire::input &input,
+                     const wire::field &field,
+                     uint32_t wire_type,
+                     bool &value) const {
+        wire::from_bits(field.encoding, input.read_value(field.encoding, wire_type), value);
+      }
+
+      void read_json(reader &reader, bool &value) const {
+        value = reader.read_bool();
+      }
+
+      void validate_json(reader &reader, meta::id<bool>) const {
+        reader.read_bool();
+      }
     };  // boolean
 
     class enumeration {
@@ -435,9 +798,56 @@ namespace jpc {
       meta::if_<std::is_enum<Enum>,
       json::string<Enum, enumeration>> json(Enum value) const { return {value}; }
 
+      template <typename Enum>
+      auto json_size(Enum value) const RETURN(this->json(value).size())
+
       template <typename Enum>
       meta::if_<std::is_enum<Enum>,
       Enum> protobuf(Enum value) const { return value; }
+
+      /* As its number, i.e. an int32. */
+      template <typename Enum>
+      meta::if_<std::is_enum<Enum>,
+      uint64_t> wire_bits(wire::encoding encoding, Enum value) const {
+        return wire::bits(encoding, static_cast<int64_t>(value));
+      }
+
+      template <typename Enum>
+      std::size_t wire_size(const wire::field &field, Enum value, wire::sizes &) const {
+        return wire::scalar_size(field, wire_bits(field.encoding, value));
+      }
+
+      template <typename Writer, typename Enum>
+      void write_wire(Writer &writer,
+                      const wire::field &field,
+                      Enum value,
+                      wire::sizes &) const {
+        wire::write_scalar(writer, field, wire_bits(field.encoding, value));
+      }
+
+      template <typename Enum>
+      meta::if_<std::is_enum<Enum>,
+      void> read_wire(wire::input &input,
+                      const wire::field &field,
+                      uint32_t wire_type,
+                      Enum &value) const {
+        int64_t number;
+        wire::from_bits(field.encoding, input.read_value(field.encoding, wire_type), number);
+        value = static_cast<Enum>(number);
+      }
+
+      template <typename Enum>
+      meta::if_<std::is_enum<Enum>,
+      void> read_json(reader &reader, Enum &value) const {
+        value = static_cast<Enum>(
+            reader.read_integer<std::underlying_type_t<Enum>>());
+      }
+
+      template <typename Enum>
+      meta::if_<std::is_enum<Enum>,
+      void> validate_json(reader &reader, meta::id<Enum>) const {
+        reader.read_integer<std::underlying_type_t<Enum>>();
+      }
     };  // enumeration
 
     class number {
@@ -449,37 +859,189 @@ namespace jpc {
       json::string<double, number> json(double value) const { return {value}; }
       json::string<float, number> json(float value) const { return {value}; }
 
+      template <typename Arithmetic>
+      auto json_size(Arithmetic value) const RETURN(this->json(value).size())
+
       int32_t protobuf(int32_t value) const { return value; }
       int64_t protobuf(int64_t value) const { return value; }
       uint32_t protobuf(uint32_t value) const { return value; }
       uint64_t protobuf(uint64_t value) const { return value; }
       double protobuf(double value) const { return value; }
       float protobuf(float value) const { return value; }
+
+      template <typename Arithmetic>
+      auto wire_bits(wire::encoding encoding, Arithmetic value) const
+        RETURN(wire::bits(encoding, this->protobuf(value)))
+
+      template <typename Arithmetic>
+      std::size_t wire_size(const wire::field &field,
+                            Arithmetic value,
+                            wire::sizes &) const {
+        return wire::scalar_size(field, wire_bits(field.encoding, value));
+      }
+
+      template <typename Writer, typename Arithmetic>
+      void write_wire(Writer &writer,
+                      const wire::field &field,
+                      Arithmetic value,
+                      wire::sizes &) const {
+        wire::write_scalar(writer, field, wire_bits(field.encoding, value));
+      }
+
+      template <typename Arithmetic>
+      void read_wire(wire::input &input,
+                     const wire::field &field,
+                     uint32_t wire_type,
+                     Arithmetic &value) const {
+        wire::from_bits(field.encoding, input.read_value(field.encoding, wire_type), value);
+      }
+
+      template <typename Integral>
+      meta::if_<std::is_integral<Integral>,
+      void> read_json(reader &reader, Integral &value) const {
+        value = reader.read_integer<Integral>();
+      }
+
+      template <typename Float>
+      meta::if_<std::is_floating_point<Float>,
+      void> read_json(reader &reader, Float &value) const {
+        value = reader.read_float<Float>();
+      }
+
+      template <typename Integral>
+      meta::if_<std::is_integral<Integral>,
+      void> validate_json(reader &reader, meta::id<Integral>) const {
+        reader.read_integer<Integral>();
+      }
+
+      template <typename Float>
+      meta::if_<std::is_floating_point<Float>,
+      void> validate_json(reader &reader, meta::id<Float>) const {
+        reader.check_float<Float>();
+      }
     };  // number
 
     class string {
       public:
-      json::string<std::string, string> json(std::string value) const {
+      json::string<std::string, string> json(const std::string &value) const {
         return {value};
       }
 
+      std::size_t json_size(const std::string &value) const {
+        return json(value).size();
+      }
+
       std::string protobuf(std::string value) const { return std::move(value); }
+
+      std::size_t wire_size(const wire::field &field,
+                            const std::string &value,
+                            wire::sizes &) const {
+        return wire::length_delimited_size(field, value.size());
+      }
+
+      template <typename Writer>
+      void write_wire(Writer &writer,
+                      const wire::field &field,
+                      const std::string &value,
+                      wire::sizes &) const {
+        wire::write_length(writer, field, value.size());
+        writer.write(value.data(), value.size());
+      }
+
+      void read_wire(wire::input &input,
+                     const wire::field &,
+                     uint32_t wire_type,
+                     std::string &value) const {
+        auto bytes = input.read_bytes(wire_type);
+        value.assign(bytes.first, bytes.second);
+      }
+
+      void read_json(reader &reader, std::string &value) const {
+        reader.read_string(value);
+      }
+
+      void validate_json(reader &reader, meta::id<std::string>) const {
+        reader.check_string();
+      }
     };  // string
 
+    /* string_view: a string member that refers to its characters rather
+       than owning them, e.g. `boost::string_view` or any type constructible
+       from `(const char *, std::size_t)` with `data()` and `size()`.
+
+       Parsing points it straight into the input when the JSON string has
+       no escapes, so the input must outlive the object. Strings with
+       escapes are unescaped into the `string_arena` passed to `from_json`,
+       which must outlive it too. */
+    class string_view {
+      public:
+      template <typename View>
+      auto json(const View &value) const -> meta::_t<decltype(
+          value.data(), value.size(), meta::id<json::string<View, string_view>>{})> {
+        return {value};
+      }
+
+      template <typename View>
+      auto json_size(const View &value) const RETURN(this->json(value).size())
+
+      template <typename View>
+      std::string protobuf(const View &value) const {
+        return std::string(value.data(), value.size());
+      }
+
+      template <typename View>
+      std::size_t wire_size(const wire::field &field, const View &value, wire::sizes &) const {
+        return wire::length_delimited_size(field, value.size());
+      }
+
+      template <typename Writer, typename View>
+      void write_wire(Writer &writer,
+                      const wire::field &field,
+                      const View &value,
+                      wire::sizes &) const {
+        wire::write_length(writer, field, value.size());
+        writer.write(value.data(), value.size());
+      }
+
+      /* Always into the input, which has no escapes. */
+      template <typename View>
+      void read_wire(wire::input &input,
+                     const wire::field &,
+                     uint32_t wire_type,
+                     View &value) const {
+        auto bytes = input.read_bytes(wire_type);
+        value = View(bytes.first, bytes.second);
+      }
+
+      template <typename View>
+      void read_json(reader &reader, View &value) const {
+        auto s = reader.read_string_view();
+        value = View(s.first, s.second);
+      }
+
+      /* Nothing is kept, so escapes need no `string_arena` here. */
+      template <typename View>
+      void validate_json(reader &reader, meta::id<View>) const {
+        reader.check_string();
+      }
+    };  // string_view
+
     template <typename Schema>
     class array {
       public:
       constexpr array(Schema schema) : schema_(std::move(schema)) {}
 
-      private:
-      Schema schema_;
-
+      /* Any single-pass range works, so elements can be produced on the
+         fly while the output streams into a `sink_writer` or `fd_writer`. */
       template <typename Iter>
       auto json(Iter first, Iter last) const -> meta::_t<decltype(
           first != last, ++first, meta::id<json::string<Iter, array>>{})> {
         return {first, last, schema_};
       }
 
+      private:
+      Schema schema_;
+
       template <typename Iter>
       auto protobuf(Iter first, Iter last) const
           -> meta::_t<decltype(first != last,
@@ -487,52 +1049,503 @@ namespace jpc {
                                meta::id<protobuf::repeated<decltype(
                                    this->schema_.protobuf(*first))>>{})> {
         protobuf::repeated<decltype(schema_.protobuf(*first))> result;
+        reserve(result, first, last, 0);
         for (; first != last; ++first) {
           protobuf::set_elem(result.Add(), schema_.protobuf(*first));
         }  // for
         return result;
       }
 
+      /* Room for every element up front, if the range can be measured
+         without consuming it. */
+      template <typename Repeated, typename Iter>
+      static auto reserve(Repeated &repeated, Iter first, Iter last, int)
+          -> std::enable_if_t<std::is_convertible<
+              typename std::iterator_traits<Iter>::iterator_category,
+              std::forward_iterator_tag>::value> {
+        repeated.Reserve(static_cast<int>(std::distance(first, last)));
+      }
+
+      template <typename Repeated, typename Iter>
+      static void reserve(Repeated &, Iter, Iter, long) {}
+
       public:
       template <typename Iterable>
       auto json(const Iterable &value) const
         RETURN(this->json(adl::adl_begin(value), adl::adl_end(value)))
 
+      template <typename Iterable>
+      auto json_size(const Iterable &value) const
+        RETURN(this->json(value).size())
+
       template <typename Iterable>
       auto protobuf(const Iterable &value) const
         RETURN(this->protobuf(adl::adl_begin(value), adl::adl_end(value)))
-    };  // array
 
-    template <typename Schema, typename F>
-    class field {
-      public:
-      field(Schema schema, F f, const char *name)
-          : schema_(std::move(schema)),
-            f_(std::move(f)),
-            name_(std::move(name)) {}
+      /* As one length-delimited run if the field is packed, otherwise as a
+         tagged value per element. */
+      template <typename Iterable>
+      std::size_t wire_size(const wire::field &field,
+                            const Iterable &value,
+                            wire::sizes &sizes) const {
+        if (field.packed) {
+          std::size_t size = packed_size(field.encoding, value, is_packable<Schema>{});
+          return size ? wire::length_delimited_size(field, size) : 0;
+        }  // if
+        std::size_t result = 0;
+        for (const auto &elem : value) {
+          result += schema_.wire_size(field, elem, sizes);
+        }  // for
+        return result;
+      }
 
-      private:
-      template <typename Object>
-      void json_object(std::ostream &strm, const Object &value) const {
-        strm << string{}.json(name_) << ':'
-             << schema_.json(detail::invoke(f_, value));
+      template <typename Writer, typename Iterable>
+      void write_wire(Writer &writer,
+                      const wire::field &field,
+                      const Iterable &value,
+                      wire::sizes &sizes) const {
+        if (field.packed) {
+          write_packed(writer, field, value, is_packable<Schema>{});
+          return;
+        }  // if
+        for (const auto &elem : value) {
+          schema_.write_wire(writer, field, elem, sizes);
+        }  // for
       }
 
-      Schema schema_;
-      F f_;
-      const char *name_;
+      /* Appends one element, or a packed run of them; the caller clears
+         `value` first. Scalars are read packed or not, whichever way the
+         field was written. */
+      template <typename Container>
+      void read_wire(wire::input &input,
+                     const wire::field &field,
+                     uint32_t wire_type,
+                     Container &value) const {
+        read_wire(input, field, wire_type, value, is_packable<Schema>{});
+      }
 
-      template <typename, typename>
-      friend class json::string;
+      /* Replaces the contents of any container with `clear` and
+         `insert(end, value)`, e.g. `std::vector` or `std::set`. */
+      template <typename Container>
+      void read_json(reader &reader, Container &value) const {
+        value.clear();
+        reader.expect('[');
+        if (reader.consume(']')) {
+          return;
+        }  // if
+        do {
+          read_json_element(reader, value);
+        } while (reader.consume(','));
+        reader.expect(']');
+      }
 
-      template <typename Object, typename Message, typename... Fields>
-      friend class object;
-    };  // field
+      template <typename Container>
+      void validate_json(reader &reader, meta::id<Container>) const {
+        reader.expect('[');
+        if (reader.consume(']')) {
+          return;
+        }  // if
+        do {
+          schema_.validate_json(reader, meta::id<typename Container::value_type>{});
+        } while (reader.consume(','));
+        reader.expect(']');
+      }
 
-    template <typename Schema>
-    class optional {
-      public:
-      optional(Schema schema) : schema_(std::move(schema)) {}
+      /* Reads `value` from chunks of input as they arrive. */
+      template <typename Container>
+      push_parser<Container, array> parser(Container &value) const {
+        return {*this, value, nullptr};
+      }
+
+      template <typename Container>
+      push_parser<Container, array> parser(Container &value,
+                                           string_arena &arena) const {
+        return {*this, value, &arena};
+      }
+
+      private:
+      template <typename Container>
+      void read_json_element(reader &reader, Container &value) const {
+        typename Container::value_type elem{};
+        schema_.read_json(reader, elem);
+        value.insert(value.end(), std::move(elem));
+      }
+
+      template <typename Iterable>
+      std::size_t packed_size(wire::encoding encoding,
+                              const Iterable &value,
+                              std::true_type) const {
+        std::size_t result = 0;
+        for (const auto &elem : value) {
+          result += wire::value_size(encoding, schema_.wire_bits(encoding, elem));
+        }  // for
+        return result;
+      }
+
+      /* Only scalars are ever packed. */
+      template <typename Iterable>
+      std::size_t packed_size(wire::encoding, const Iterable &, std::false_type) const {
+        return 0;
+      }
+
+      template <typename Writer, typename Iterable>
+      void write_packed(Writer &writer,
+                        const wire::field &field,
+                        const Iterable &value,
+                        std::true_type) const {
+        std::size_t size = packed_size(field.encoding, value, std::true_type{});
+        if (!size) {
+          return;
+        }  // if
+        wire::write_length(writer, field, size);
+        for (const auto &elem : value) {
+          wire::write_value(writer, field.encoding, schema_.wire_bits(field.encoding, elem));
+        }  // for
+      }
+
+      template <typename Writer, typename Iterable>
+      void write_packed(Writer &,
+                        const wire::field &,
+                        const Iterable &,
+                        std::false_type) const {}
+
+      template <typename Container>
+      void read_wire(wire::input &input,
+                     const wire::field &field,
+                     uint32_t wire_type,
+                     Container &value,
+                     std::true_type) const {
+        if (wire_type != 2) {
+          read_wire_element(input, field, wire_type, value);
+          return;
+        }  // if
+        const char *last = input.push_limit(input.read_length(wire_type));
+        while (!input.done()) {
+          read_wire_element(input, field, wire::wire_type(field.encoding), value);
+        }  // while
+        input.pop_limit(last);
+      }
+
+      template <typename Container>
+      void read_wire(wire::input &input,
+                     const wire::field &field,
+                     uint32_t wire_type,
+                     Container &value,
+                     std::false_type) const {
+        read_wire_element(input, field, wire_type, value);
+      }
+
+      template <typename Container>
+      void read_wire_element(wire::input &input,
+                             const wire::field &field,
+                             uint32_t wire_type,
+                             Container &value) const {
+        typename Container::value_type elem{};
+        schema_.read_wire(input, field, wire_type, elem);
+        value.insert(value.end(), std::move(elem));
+      }
+
+      template <typename, typename>
+      friend class push_parser;
+    };  // array
+
+    template <typename Schema, typename F, std::size_t Length, typename Accessor>
+    class field {
+      public:
+      field(Schema schema, F f, const char *name, Accessor accessor = {})
+          : schema_(std::move(schema)),
+            f_(std::move(f)),
+            name_(std::move(name)),
+            key_(json_key(name_)),
+            accessor_(std::move(accessor)) {}
+
+      private:
+      /* Renders `,"name":` once, so that emitting a key is a single `write`.
+         The first field of an object skips the leading `,`. */
+      static std::string json_key(const char *name) {
+        std::string result = ",";
+        {
+          string_writer writer(result);
+          string{}.json(name).write(writer);
+        }
+        result += ':';
+        return result;
+      }
+
+      template <typename Writer, typename Object>
+      void json_object(Writer &writer, const Object &value, bool first) const {
+        writer.write(key_.data() + first, key_.size() - first);
+        schema_.json(detail::invoke(f_, value)).write(writer);
+      }
+
+      template <typename Object>
+      std::size_t json_object_size(const Object &value, bool first) const {
+        return key_.size() - first +
+               schema_.json(detail::invoke(f_, value)).size();
+      }
+
+      std::pair<const char *, std::size_t> name() const {
+        return {name_, Length};
+      }
+
+      template <typename Object>
+      void read_json_object(reader &reader, Object &value) const {
+        using Member = decltype(detail::invoke(f_, value));
+        static_assert(std::is_lvalue_reference<Member>{} &&
+                          !std::is_const<std::remove_reference_t<Member>>{},
+                      "from_json needs fields that name data members");
+        schema_.read_json(reader, detail::invoke(f_, value));
+      }
+
+      /* The key was absent: an `optional` is reset, anything else is an
+         error. */
+      template <typename Object>
+      void read_json_missing(reader &reader, Object &value) const {
+        read_json_missing(reader, detail::invoke(f_, value), is_optional<Schema>{});
+      }
+
+      template <typename T>
+      void read_json_missing(reader &, T &member, std::true_type) const {
+        member = T{};
+      }
+
+      template <typename T>
+      void read_json_missing(reader &reader, T &, std::false_type) const {
+        missing(reader);
+      }
+
+      /* Reads the value into the field of `message`, a `M`, that has this
+         name. The value goes through the member's C++ type, so it is
+         checked and converted just as `from_json` then `protobuf` would,
+         and is set through the generated accessor if the field names one;
+         a nested `object` reads straight into its sub-message. */
+      template <typename Object, typename M>
+      void read_protobuf(reader &reader,
+                         M &message,
+                         const google::protobuf::FieldDescriptor *field_descriptor,
+                         const google::protobuf::Reflection *reflection) const {
+        assert(field_descriptor);
+        read_protobuf<Object>(reader, message, field_descriptor, reflection, schema_);
+      }
+
+      template <typename Object, typename M, typename S>
+      void read_protobuf(reader &reader,
+                         M &message,
+                         const google::protobuf::FieldDescriptor *field_descriptor,
+                         const google::protobuf::Reflection *reflection,
+                         const S &) const {
+        member_t<F, Object> member{};
+        schema_.read_json(reader, member);
+        auto field = schema_.protobuf(std::move(member));
+        assert(protobuf::type_check<decltype(field)>(field_descriptor));
+        set_protobuf(message, field_descriptor, reflection, std::move(field));
+      }
+
+      template <typename Object, typename M, typename O, typename N, typename... Fs>
+      void read_protobuf(reader &reader,
+                         M &message,
+                         const google::protobuf::FieldDescriptor *field_descriptor,
+                         const google::protobuf::Reflection *reflection,
+                         const object<O, N, Fs...> &) const {
+        schema_.read_protobuf(
+            reader, mutable_message(message, field_descriptor, reflection));
+      }
+
+      template <typename Object>
+      void validate_json(reader &reader) const {
+        schema_.validate_json(reader, meta::id<member_t<F, Object>>{});
+      }
+
+      /* One occurrence of the field in wire bytes. A repeated field is
+         cleared at its `first` and appended to from then on; a nested
+         message is read afresh at its `first` and merged into from then
+         on, as protobuf does. */
+      template <typename Object>
+      void read_wire_object(wire::input &input,
+                            const wire::field &field,
+                            uint32_t wire_type,
+                            Object &value,
+                            bool first) const {
+        using Member = decltype(detail::invoke(f_, value));
+        static_assert(std::is_lvalue_reference<Member>{} &&
+                          !std::is_const<std::remove_reference_t<Member>>{},
+                      "from_protobuf_bytes needs fields that name data members");
+        auto &member = detail::invoke(f_, value);
+        if (first) {
+          clear_repeated(member, schema_);
+          schema_.read_wire(input, field, wire_type, member);
+        } else {
+          merge_wire(input, field, wire_type, member, schema_);
+        }  // if
+      }
+
+      template <typename T, typename S>
+      static void merge_wire(wire::input &input,
+                             const wire::field &field,
+                             uint32_t wire_type,
+                             T &value,
+                             const S &schema) {
+        schema.read_wire(input, field, wire_type, value);
+      }
+
+      template <typename T, typename O, typename M, typename... Fs>
+      static void merge_wire(wire::input &input,
+                             const wire::field &field,
+                             uint32_t wire_type,
+                             T &value,
+                             const object<O, M, Fs...> &schema) {
+        schema.merge_wire(input, field, wire_type, value);
+      }
+
+      template <typename T, typename O, typename M, typename... Fs>
+      static void merge_wire(wire::input &input,
+                             const wire::field &field,
+                             uint32_t wire_type,
+                             T &value,
+                             const optional<object<O, M, Fs...>> &schema) {
+        schema.merge_wire(input, field, wire_type, value);
+      }
+
+      template <typename T, typename S>
+      static void clear_repeated(T &, const S &) {}
+
+      template <typename Container, typename S>
+      static void clear_repeated(Container &value, const array<S> &) {
+        value.clear();
+      }
+
+      /* The field was absent from wire bytes: an error if the message
+         requires it, otherwise the member is reset, e.g. a repeated field
+         is empty. */
+      template <typename Object>
+      void read_wire_missing(wire::input &input, Object &value, bool required) const {
+        if (required) {
+          input.fail("missing field \"" + std::string(name_, Length) + '"');
+        }  // if
+        auto &member = detail::invoke(f_, value);
+        member = std::decay_t<decltype(member)>{};
+      }
+
+      /* The key was absent where nothing is reset, e.g. in JSON read into
+         a message or only validated: fine for an `optional`. */
+      void check_missing(reader &reader) const {
+        if (!is_optional<Schema>{}) {
+          missing(reader);
+        }  // if
+      }
+
+      [[noreturn]] void missing(reader &reader) const {
+        reader.fail("missing field \"" + std::string(name_, Length) + '"');
+      }
+
+      /* Sets the converted member on `message`, a `M`, through the
+         generated accessor if the field names one. */
+      template <typename M, typename T>
+      void set_protobuf(M &message,
+                        const google::protobuf::FieldDescriptor *field_descriptor,
+                        const google::protobuf::Reflection *reflection,
+                        T &&value) const {
+        set_protobuf(message, field_descriptor, reflection, std::move(value), accessor_);
+      }
+
+      /* A message known only as a `google::protobuf::Message`, e.g. a
+         dynamic one, is set through reflection whatever the field names. */
+      template <typename T>
+      void set_protobuf(google::protobuf::Message &message,
+                        const google::protobuf::FieldDescriptor *field_descriptor,
+                        const google::protobuf::Reflection *reflection,
+                        T &&value) const {
+        protobuf::set_field{&message, field_descriptor, reflection}(std::move(value));
+      }
+
+      template <typename M, typename T>
+      void set_protobuf(M &message,
+                        const google::protobuf::FieldDescriptor *field_descriptor,
+                        const google::protobuf::Reflection *reflection,
+                        T &&value,
+                        reflective) const {
+        protobuf::set_field{&message, field_descriptor, reflection}(std::move(value));
+      }
+
+      template <typename M, typename T, typename A>
+      void set_protobuf(M &message,
+                        const google::protobuf::FieldDescriptor *,
+                        const google::protobuf::Reflection *,
+                        T &&value,
+                        A accessor) const {
+        protobuf::set_generated<M, A>{&message, accessor}(std::move(value));
+      }
+
+      /* The sub-message of `message`, a `M`, that this field names, in the
+         same way. */
+      template <typename M>
+      google::protobuf::Message &mutable_message(
+          M &message,
+          const google::protobuf::FieldDescriptor *field_descriptor,
+          const google::protobuf::Reflection *reflection) const {
+        return mutable_message(message, field_descriptor, reflection, accessor_);
+      }
+
+      google::protobuf::Message &mutable_message(
+          google::protobuf::Message &message,
+          const google::protobuf::FieldDescriptor *field_descriptor,
+          const google::protobuf::Reflection *reflection) const {
+        return *reflection->MutableMessage(&message, field_descriptor);
+      }
+
+      template <typename M>
+      google::protobuf::Message &mutable_message(
+          M &message,
+          const google::protobuf::FieldDescriptor *field_descriptor,
+          const google::protobuf::Reflection *reflection,
+          reflective) const {
+        return *reflection->MutableMessage(&message, field_descriptor);
+      }
+
+      template <typename M, typename Field>
+      google::protobuf::Message &mutable_message(
+          M &message,
+          const google::protobuf::FieldDescriptor *,
+          const google::protobuf::Reflection *,
+          Field *(M::*mutable_)()) const {
+        return *(message.*mutable_)();
+      }
+
+      Schema schema_;
+      F f_;
+      const char *name_;
+      std::string key_;
+      Accessor accessor_;
+
+      template <typename, typename>
+      friend class json::string;
+
+      template <typename Object, typename Message, typename... Fields>
+      friend class object;
+    };  // field
+
+    /* The value inside an optional, default-constructed first if empty. */
+
+    template <typename T>
+    T &engage(boost::optional<T> &value) {
+      if (!value) {
+        value = T{};
+      }  // if
+      return *value;
+    }
+
+    template <typename T>
+    T &engage(std::unique_ptr<T> &value) {
+      if (!value) {
+        value = std::make_unique<T>();
+      }  // if
+      return *value;
+    }
+
+    template <typename Schema>
+    class optional {
+      public:
+      optional(Schema schema) : schema_(std::move(schema)) {}
 
       private:
       template <typename Optional>
@@ -540,13 +1553,69 @@ namespace jpc {
         return {value, schema_};
       }
 
+      template <typename Optional>
+      std::size_t json_size(const Optional &value) const {
+        return json(value).size();
+      }
+
       template <typename Optional>
       auto protobuf(const Optional &value) const
         RETURN(value ? boost::make_optional(*value) : boost::none)
 
+      /* Nothing at all when empty. */
+      template <typename Optional>
+      std::size_t wire_size(const wire::field &field,
+                            const Optional &value,
+                            wire::sizes &sizes) const {
+        return value ? schema_.wire_size(field, *value, sizes) : 0;
+      }
+
+      template <typename Writer, typename Optional>
+      void write_wire(Writer &writer,
+                      const wire::field &field,
+                      const Optional &value,
+                      wire::sizes &sizes) const {
+        if (value) {
+          schema_.write_wire(writer, field, *value, sizes);
+        }  // if
+      }
+
+      template <typename Optional>
+      void read_wire(wire::input &input,
+                     const wire::field &field,
+                     uint32_t wire_type,
+                     Optional &value) const {
+        schema_.read_wire(input, field, wire_type, engage(value));
+      }
+
+      template <typename Optional>
+      void merge_wire(wire::input &input,
+                      const wire::field &field,
+                      uint32_t wire_type,
+                      Optional &value) const {
+        schema_.merge_wire(input, field, wire_type, engage(value));
+      }
+
+      template <typename Optional>
+      void read_json(reader &reader, Optional &value) const {
+        if (reader.consume_literal("null")) {
+          value = Optional{};
+          return;
+        }  // if
+        schema_.read_json(reader, engage(value));
+      }
+
+      template <typename Optional>
+      void validate_json(reader &reader, meta::id<Optional>) const {
+        if (!reader.consume_literal("null")) {
+          schema_.validate_json(
+              reader, meta::id<std::decay_t<decltype(*std::declval<Optional &>())>>{});
+        }  // if
+      }
+
       Schema schema_;
 
-      template <typename, typename>
+      template <typename, typename, std::size_t, typename>
       friend class field;
 
       template <typename Object, typename Message, typename... Fields>
@@ -556,9 +1625,18 @@ namespace jpc {
     template <typename Object, typename Message, typename... Fields>
     class object {
       public:
-      template <typename... Schemas, typename... Fs>
-      constexpr object(field<Schemas, Fs>... fields)
-          : fields_{std::move(fields)...} {}
+      template <typename... Schemas,
+                typename... Fs,
+                std::size_t... Lengths,
+                typename... Accessors>
+      constexpr object(field<Schemas, Fs, Lengths, Accessors>... fields)
+          : fields_{std::move(fields)...},
+            keys_(keys(fields_)),
+            field_descriptors_(resolve(fields_, std::is_abstract<Message>{})),
+            reflection_(reflection(std::is_abstract<Message>{})),
+            wire_fields_(layout(field_descriptors_)),
+            numbers_(numbers(field_descriptors_)),
+            required_(required(field_descriptors_)) {}
 
       /* runtime type checkers */
 
@@ -569,12 +1647,11 @@ namespace jpc {
 
       const object &protobuf(Cpp) const {
         Message dummy;
-        const auto *descriptor = dummy.GetDescriptor();
         detail::apply(
-            [&](Fields... fields) {
+            [&](const Fields &... fields) {
+              std::size_t i = 0;
               int for_each[] = {[&] {
-                const auto *field_descriptor =
-                    descriptor->FindFieldByName(fields.name_);
+                const auto *field_descriptor = field_descriptors_[i++];
                 if (!field_descriptor) {
                   throw std::runtime_error("missing field");
                 }  // if
@@ -583,7 +1660,7 @@ namespace jpc {
                 if (!protobuf::type_check<T>(field_descriptor)) {
                   throw std::runtime_error("type check failed");
                 }  // if
-                protobuf::set_field{&dummy, field_descriptor}(T{});
+                protobuf::set_field{&dummy, field_descriptor, reflection_}(T{});
                 return 0;
               }()...};
               (void)for_each;
@@ -606,21 +1683,130 @@ namespace jpc {
         return {value, fields_};
       }
 
+      /* The exact number of bytes `json(value)` writes. */
+      std::size_t json_size(const Object &value) const {
+        return json(value).size();
+      }
+
+      /* Serializes onto `buffer` without touching the heap and returns the
+         number of bytes written. Only for bounded schemas, see
+         `max_json_size`. */
+      template <std::size_t N>
+      std::size_t json_to(const Object &value, std::array<char, N> &buffer) const {
+        static_assert(N >= MaxJsonSize<object>::value,
+                      "buffer is smaller than max_json_size");
+        span_writer writer(buffer.data(), N);
+        json(value).write(writer);
+        return writer.size();
+      }
+
+      /* Parses JSON text straight into `value` through the fields' member
+         pointers, with no DOM in between. Keys may come in any order; every
+         field that is not `optional` must be present, and absent `optional`
+         ones are reset. Members under keys the schema does not declare are
+         skipped, nested objects and arrays included, and never decoded.
+         `string_view` fields point into the text, and escaped strings can
+         only be read into them given a `string_arena`. Throws
+         `parse_error`. */
+      parse_result from_json(const char *first, const char *last, Object &value) const {
+        return from_json(first, last, value, nullptr);
+      }
+
+      parse_result from_json(const char *first,
+                             const char *last,
+                             Object &value,
+                             string_arena &arena) const {
+        return from_json(first, last, value, &arena);
+      }
+
+      parse_result from_json(const std::string &text, Object &value) const {
+        return from_json(text.data(), text.data() + text.size(), value);
+      }
+
+      parse_result from_json(const std::string &text,
+                             Object &value,
+                             string_arena &arena) const {
+        return from_json(text.data(), text.data() + text.size(), value, arena);
+      }
+
+      void read_json(reader &reader, Object &value) const {
+        read_json(reader, value, std::index_sequence_for<Fields...>{});
+      }
+
+      /* Runs every check `from_json` does, down to the ranges of numbers
+         and the escapes in strings, but keeps nothing: no member is
+         written and, for valid input, nothing is allocated, so it is
+         cheap enough to screen payloads before committing to a parse.
+         Throws `parse_error` with the first error and its offset. */
+      parse_result validate_json(const char *first, const char *last) const {
+        reader reader(first, last);
+        validate_json(reader, meta::id<Object>{});
+        reader.finish();
+        return {reader.skipped()};
+      }
+
+      parse_result validate_json(const std::string &text) const {
+        return validate_json(text.data(), text.data() + text.size());
+      }
+
+      void validate_json(reader &reader, meta::id<Object>) const {
+        validate_json(reader, std::index_sequence_for<Fields...>{});
+      }
+
+      /* Parses JSON text straight into a `Message`, through the same
+         fields and with the same checks as `from_json`, but without an
+         `Object` in between. Absent `optional` fields are left unset. */
+      Message json_to_protobuf(const char *first, const char *last) const {
+        Message result;
+        reader reader(first, last);
+        read_protobuf(reader, result);
+        reader.finish();
+        return result;
+      }
+
+      Message json_to_protobuf(const std::string &text) const {
+        return json_to_protobuf(text.data(), text.data() + text.size());
+      }
+
+      /* Into `message`, which has `Message`'s descriptor, e.g. a nested
+         message of an enclosing object's. */
+      void read_protobuf(reader &reader, google::protobuf::Message &message) const {
+        const auto *reflection = message.GetReflection();
+        if (reflection == reflection_) {
+          // A `Message`, so generated accessors apply.
+          read_protobuf(reader, static_cast<Message &>(message), field_descriptors_,
+                        reflection, std::index_sequence_for<Fields...>{});
+        } else {
+          // Not a `Message` after all, e.g. a dynamic one.
+          read_protobuf(reader, message, resolve(fields_, message.GetDescriptor()),
+                        reflection, std::index_sequence_for<Fields...>{});
+        }  // if
+      }
+
+      /* Reads `value` from chunks of input as they arrive. `string_view`
+         fields need `arena`, since the chunks do not outlive the parse. */
+      push_parser<Object, object> parser(Object &value) const {
+        return {*this, value, nullptr};
+      }
+
+      push_parser<Object, object> parser(Object &value, string_arena &arena) const {
+        return {*this, value, &arena};
+      }
+
       Message protobuf(const Object &value) const {
         Message result;
-        const auto *descriptor = result.GetDescriptor();
         detail::apply(
-            [&](Fields... fields) {
+            [&](const Fields &... fields) {
+              std::size_t i = 0;
               int for_each[] = {[&] {
                 using protobuf::type_check;
-                using protobuf::set_field;
-                const auto *field_descriptor =
-                    descriptor->FindFieldByName(fields.name_);
+                const auto *field_descriptor = field_descriptors_[i++];
                 assert(field_descriptor);
                 auto field =
                     fields.schema_.protobuf(detail::invoke(fields.f_, value));
                 assert(type_check<decltype(field)>(field_descriptor));
-                set_field{&result, field_descriptor}(std::move(field));
+                fields.set_protobuf(
+                    result, field_descriptor, reflection_, std::move(field));
                 return 0;
               }()...};
               (void)for_each;
@@ -630,10 +1816,575 @@ namespace jpc {
         return result;
       }
 
+      /* Encodes `value` in the protobuf wire format straight from its
+         members: the bytes parse back into what `protobuf(value)` builds,
+         but no `Message` is built on the way. Fields go out in the order
+         the schema lists them, not by number, and empty `optional`s not at
+         all. */
+      std::string protobuf_bytes(const Object &value) const {
+        wire::sizes sizes;
+        std::string result(wire_fields_size(value, sizes), '\0');
+        span_writer writer(&result[0], result.size());
+        write_wire_fields(writer, value, sizes);
+        return result;
+      }
+
+      /* Sizes each nested message as it comes to it. */
+      template <typename Writer>
+      void protobuf_bytes(const Object &value, basic_writer<Writer> &writer) const {
+        wire::sizes sizes;
+        write_wire_fields(static_cast<Writer &>(writer), value, sizes);
+      }
+
+      /* Straight into the stream's buffer if it has room for all of it. */
+      void protobuf_bytes(const Object &value,
+                          google::protobuf::io::CodedOutputStream &stream) const {
+        wire::sizes sizes;
+        const std::size_t size = wire_fields_size(value, sizes);
+        if (auto *p = stream.GetDirectBufferForNBytesAndAdvance(static_cast<int>(size))) {
+          span_writer writer(reinterpret_cast<char *>(p), size);
+          write_wire_fields(writer, value, sizes);
+          return;
+        }  // if
+        auto sink = [&](const char *s, std::size_t n) {
+          stream.WriteRaw(s, static_cast<int>(n));
+        };
+        sink_writer<decltype(sink)> writer(sink);
+        write_wire_fields(writer, value, sizes);
+      }
+
+      /* The exact number of bytes `protobuf_bytes(value)` writes. */
+      std::size_t protobuf_bytes_size(const Object &value) const {
+        wire::sizes sizes;
+        return wire_fields_size(value, sizes);
+      }
+
+      /* Decodes protobuf wire bytes, e.g. a serialized `Message`, straight
+         into `value` through the fields' member pointers, with no
+         `Message` in between. Each field is found by its number in a
+         table; fields the schema does not declare are skipped. An absent
+         field is reset, unless `Message` requires it, which is an error.
+         Repeated scalars may come packed or not. A field that occurs more
+         than once keeps the last occurrence, except that a nested message
+         is merged as protobuf merges it: its scalars are overwritten, its
+         repeated fields appended to. `string_view` fields point into the
+         bytes. Throws `parse_error`. */
+      parse_result from_protobuf_bytes(const char *first,
+                                       const char *last,
+                                       Object &value) const {
+        wire::input input(first, last);
+        read_wire_fields(input, value, false);
+        return {input.skipped()};
+      }
+
+      parse_result from_protobuf_bytes(const std::string &data, Object &value) const {
+        return from_protobuf_bytes(data.data(), data.data() + data.size(), value);
+      }
+
+      /* As the nested message in `field` of an enclosing object. */
+      std::size_t wire_size(const wire::field &field,
+                            const Object &value,
+                            wire::sizes &sizes) const {
+        const std::size_t i = sizes.reserve();
+        const std::size_t size = wire_fields_size(value, sizes);
+        sizes.set(i, size);
+        return wire::length_delimited_size(field, size);
+      }
+
+      template <typename Writer>
+      void write_wire(Writer &writer,
+                      const wire::field &field,
+                      const Object &value,
+                      wire::sizes &sizes) const {
+        const std::size_t size = sizes.empty() ? wire_fields_size(value, sizes) : sizes.next();
+        wire::write_length(writer, field, size);
+        write_wire_fields(writer, value, sizes);
+      }
+
+      void read_wire(wire::input &input,
+                     const wire::field &,
+                     uint32_t wire_type,
+                     Object &value) const {
+        const char *last = input.push_limit(input.read_length(wire_type));
+        read_wire_fields(input, value, false);
+        input.pop_limit(last);
+      }
+
+      /* A later occurrence of the nested message in `field`: nothing
+         absent is reset or required, since the earlier ones had it. */
+      void merge_wire(wire::input &input,
+                      const wire::field &,
+                      uint32_t wire_type,
+                      Object &value) const {
+        const char *last = input.push_limit(input.read_length(wire_type));
+        read_wire_fields(input, value, true);
+        input.pop_limit(last);
+      }
+
       private:
+      std::size_t wire_fields_size(const Object &value, wire::sizes &sizes) const {
+        static_assert(!std::is_abstract<Message>{},
+                      "protobuf_bytes needs the fields' numbers from Message");
+        std::size_t result = 0;
+        detail::apply(
+            [&](const Fields &... fields) {
+              std::size_t i = 0;
+              int for_each[] = {(result += fields.schema_.wire_size(
+                                     wire_fields_[i++],
+                                     detail::invoke(fields.f_, value),
+                                     sizes),
+                                 0)...};
+              (void)for_each;
+            },
+            fields_);
+        return result;
+      }
+
+      template <typename Writer>
+      void write_wire_fields(Writer &writer, const Object &value, wire::sizes &sizes) const {
+        static_assert(!std::is_abstract<Message>{},
+                      "protobuf_bytes needs the fields' numbers from Message");
+        detail::apply(
+            [&](const Fields &... fields) {
+              std::size_t i = 0;
+              int for_each[] = {(fields.schema_.write_wire(writer,
+                                                           wire_fields_[i++],
+                                                           detail::invoke(fields.f_, value),
+                                                           sizes),
+                                 0)...};
+              (void)for_each;
+            },
+            fields_);
+      }
+
+      /* Into `value` as read before, or as merged into if `merge`. */
+      void read_wire_fields(wire::input &input, Object &value, bool merge) const {
+        static_assert(!std::is_abstract<Message>{},
+                      "from_protobuf_bytes needs the fields' numbers from Message");
+        read_wire_fields(input, value, merge, std::index_sequence_for<Fields...>{});
+      }
+
+      template <std::size_t... Is>
+      void read_wire_fields(wire::input &input,
+                            Object &value,
+                            bool merge,
+                            std::index_sequence<Is...>) const {
+        using read_fn = void (*)(
+            const object &, wire::input &, uint32_t, Object &, bool);
+        static constexpr read_fn read_fields[] = {&read_wire_field<Is>...};
+        seen_fields seen;
+        while (!input.done()) {
+          uint32_t wire_type;
+          std::size_t index = numbers_.find(input.read_tag(wire_type));
+          if (index == wire::field_table::npos) {
+            input.skip(wire_type);
+            continue;
+          }  // if
+          read_fields[index](*this, input, wire_type, value, !merge && !seen[index]);
+          seen.set(index);
+        }  // while
+        if (merge) {
+          return;
+        }  // if
+        int for_each[] = {[&] {
+          if (!seen[Is]) {
+            std::get<Is>(fields_).read_wire_missing(input, value, required_[Is]);
+          }  // if
+          return 0;
+        }()...};
+        (void)for_each;
+      }
+
+      template <std::size_t I>
+      static void read_wire_field(const object &self,
+                                  wire::input &input,
+                                  uint32_t wire_type,
+                                  Object &value,
+                                  bool first) {
+        std::get<I>(self.fields_).read_wire_object(
+            input, self.wire_fields_[I], wire_type, value, first);
+      }
+
+      parse_result from_json(const char *first,
+                             const char *last,
+                             Object &value,
+                             string_arena *arena) const {
+        reader reader(first, last);
+        reader.use_arena(arena);
+        read_json(reader, value);
+        reader.finish();
+        return {reader.skipped()};
+      }
+
+      using seen_fields = std::bitset<sizeof...(Fields)>;
+
+      using field_descriptors =
+          std::array<const google::protobuf::FieldDescriptor *, sizeof...(Fields)>;
+
+      using wire_fields = std::array<wire::field, sizeof...(Fields)>;
+
+      template <std::size_t... Is>
+      void read_json(reader &reader,
+                     Object &value,
+                     std::index_sequence<Is...>) const {
+        seen_fields seen;
+        reader.expect('{');
+        if (!reader.consume('}')) {
+          do {
+            read_json_member(reader, value, seen);
+          } while (reader.consume(','));
+          reader.expect('}');
+        }  // if
+        read_json_missing(reader, value, seen);
+      }
+
+      /* One `"key": value`, noted in `seen` unless the key is unknown. */
+      void read_json_member(reader &reader, Object &value, seen_fields &seen) const {
+        read_json_member(reader, value, seen, std::index_sequence_for<Fields...>{});
+      }
+
+      template <std::size_t... Is>
+      void read_json_member(reader &reader,
+                            Object &value,
+                            seen_fields &seen,
+                            std::index_sequence<Is...>) const {
+        using read_fn = void (*)(const object &, detail::reader &, Object &);
+        static constexpr read_fn read_fields[] = {&read_field<Is>...};
+        std::size_t index = read_key(reader);
+        if (index != perfect_hash::npos) {
+          read_fields[index](*this, reader, value);
+          seen.set(index);
+        }  // if
+      }
+
+      /* The field of the next `"key":`, or `npos` once the member of an
+         unknown key has been skipped. */
+      std::size_t read_key(reader &reader) const {
+        reader.peek();
+        const std::size_t offset = reader.offset();
+        std::size_t size;
+        const char *key = reader.read_key(size);
+        std::size_t index = keys_.find(key, size);
+        reader.expect(':');
+        if (index == perfect_hash::npos) {
+          reader.skip_member(offset);
+        }  // if
+        return index;
+      }
+
+      template <typename M, std::size_t... Is>
+      void read_protobuf(reader &reader,
+                         M &message,
+                         const field_descriptors &descriptors,
+                         const google::protobuf::Reflection *reflection,
+                         std::index_sequence<Is...>) const {
+        using read_fn = void (*)(const object &,
+                                 detail::reader &,
+                                 M &,
+                                 const google::protobuf::FieldDescriptor *,
+                                 const google::protobuf::Reflection *);
+        static constexpr read_fn read_fields[] = {&read_protobuf_field<M, Is>...};
+        seen_fields seen;
+        reader.expect('{');
+        if (!reader.consume('}')) {
+          do {
+            std::size_t index = read_key(reader);
+            if (index != perfect_hash::npos) {
+              read_fields[index](*this, reader, message,
+                                 descriptors[index], reflection);
+              seen.set(index);
+            }  // if
+          } while (reader.consume(','));
+          reader.expect('}');
+        }  // if
+        int for_each[] = {[&] {
+          if (!seen[Is]) {
+            std::get<Is>(fields_).check_missing(reader);
+          }  // if
+          return 0;
+        }()...};
+        (void)for_each;
+      }
+
+      template <std::size_t... Is>
+      void validate_json(reader &reader, std::index_sequence<Is...>) const {
+        using validate_fn = void (*)(const object &, detail::reader &);
+        static constexpr validate_fn validate_fields[] = {&validate_field<Is>...};
+        seen_fields seen;
+        reader.expect('{');
+        if (!reader.consume('}')) {
+          do {
+            std::size_t index = read_key(reader);
+            if (index != perfect_hash::npos) {
+              validate_fields[index](*this, reader);
+              seen.set(index);
+            }  // if
+          } while (reader.consume(','));
+          reader.expect('}');
+        }  // if
+        int for_each[] = {[&] {
+          if (!seen[Is]) {
+            std::get<Is>(fields_).check_missing(reader);
+          }  // if
+          return 0;
+        }()...};
+        (void)for_each;
+      }
+
+      template <std::size_t I>
+      static void validate_field(const object &self, reader &reader) {
+        std::get<I>(self.fields_).template validate_json<Object>(reader);
+      }
+
+      template <typename M, std::size_t I>
+      static void read_protobuf_field(
+          const object &self,
+          reader &reader,
+          M &message,
+          const google::protobuf::FieldDescriptor *field_descriptor,
+          const google::protobuf::Reflection *reflection) {
+        std::get<I>(self.fields_).template read_protobuf<Object>(
+            reader, message, field_descriptor, reflection);
+      }
+
+      void read_json_missing(reader &reader, Object &value, const seen_fields &seen) const {
+        read_json_missing(reader, value, seen, std::index_sequence_for<Fields...>{});
+      }
+
+      template <std::size_t... Is>
+      void read_json_missing(reader &reader,
+                             Object &value,
+                             const seen_fields &seen,
+                             std::index_sequence<Is...>) const {
+        int for_each[] = {[&] {
+          if (!seen[Is]) {
+            std::get<Is>(fields_).read_json_missing(reader, value);
+          }  // if
+          return 0;
+        }()...};
+        (void)for_each;
+      }
+
+      template <std::size_t I>
+      static void read_field(const object &self, reader &reader, Object &value) {
+        std::get<I>(self.fields_).read_json_object(reader, value);
+      }
+
+      /* Resolves a key to its field in O(1), see `perfect_hash`. */
+      static perfect_hash keys(const std::tuple<Fields...> &fields) {
+        std::vector<std::pair<const char *, std::size_t>> result;
+        detail::apply(
+            [&](const Fields &... fields) {
+              int for_each[] = {(result.push_back(fields.name()), 0)...};
+              (void)for_each;
+            },
+            fields);
+        return perfect_hash(std::move(result));
+      }
+
+      /* The descriptor of each field, found by name once so that
+         conversions need not hash names; null if there is no such field. */
+      static field_descriptors resolve(const std::tuple<Fields...> &fields,
+                                       const google::protobuf::Descriptor *descriptor) {
+        field_descriptors result;
+        detail::apply(
+            [&](const Fields &... fields) {
+              std::size_t i = 0;
+              int for_each[] = {
+                  (result[i++] = descriptor->FindFieldByName(fields.name_), 0)...};
+              (void)for_each;
+            },
+            fields);
+        return result;
+      }
+
+      static field_descriptors resolve(const std::tuple<Fields...> &fields,
+                                       std::false_type) {
+        return resolve(fields, Message::descriptor());
+      }
+
+      /* The abstract `Message` leaves it to the messages at hand. */
+      static field_descriptors resolve(const std::tuple<Fields...> &, std::true_type) {
+        return {};
+      }
+
+      static const google::protobuf::Reflection *reflection(std::false_type) {
+        return Message::default_instance().GetReflection();
+      }
+
+      static const google::protobuf::Reflection *reflection(std::true_type) {
+        return nullptr;
+      }
+
+      /* How each field is laid out on the wire, from its descriptor. */
+      static wire_fields layout(const field_descriptors &descriptors) {
+        wire_fields result{};
+        for (std::size_t i = 0; i < descriptors.size(); ++i) {
+          if (descriptors[i]) {
+            result[i] = protobuf::wire_field(descriptors[i]);
+          }  // if
+        }  // for
+        return result;
+      }
+
+      /* Finds a field by number, see `wire::field_table`. */
+      static wire::field_table numbers(const field_descriptors &descriptors) {
+        std::vector<uint32_t> result;
+        for (const auto *descriptor : descriptors) {
+          result.push_back(descriptor ? static_cast<uint32_t>(descriptor->number()) : 0);
+        }  // for
+        return wire::field_table(result);
+      }
+
+      static seen_fields required(const field_descriptors &descriptors) {
+        seen_fields result;
+        for (std::size_t i = 0; i < descriptors.size(); ++i) {
+          result[i] = descriptors[i] && descriptors[i]->is_required();
+        }  // for
+        return result;
+      }
+
       std::tuple<Fields...> fields_;
+      perfect_hash keys_;
+      field_descriptors field_descriptors_;
+      const google::protobuf::Reflection *reflection_;
+      wire_fields wire_fields_;
+      wire::field_table numbers_;
+      seen_fields required_;
+
+      template <typename, typename>
+      friend class push_parser;
     };  // object
 
+    /* push_parser: `from_json` for input that arrives in chunks, see
+       `basic_push_parser`. Members are read into the object as they
+       complete, and fields are checked for absence at the closing brace.
+       An array reads its elements as they complete, e.g. a long stream of
+       records. */
+
+    template <typename Object, typename Message, typename... Fields>
+    class push_parser<Object, object<Object, Message, Fields...>>
+        : public basic_push_parser<
+              push_parser<Object, object<Object, Message, Fields...>>, '{', '}'> {
+      public:
+      using schema = object<Object, Message, Fields...>;
+
+      push_parser(const schema &schema, Object &value, string_arena *arena)
+          : push_parser::basic_push_parser(arena), schema_(schema), value_(value) {}
+
+      private:
+      void read_begin() { seen_.reset(); }
+
+      void read_item(reader &reader) {
+        schema_.read_json_member(reader, value_, seen_);
+      }
+
+      void read_end(reader &reader) {
+        schema_.read_json_missing(reader, value_, seen_);
+      }
+
+      const schema &schema_;
+      Object &value_;
+      typename schema::seen_fields seen_;
+
+      friend class basic_push_parser<push_parser, '{', '}'>;
+    };  // push_parser
+
+    template <typename Container, typename Schema>
+    class push_parser<Container, array<Schema>>
+        : public basic_push_parser<push_parser<Container, array<Schema>>, '[', ']'> {
+      public:
+      push_parser(const array<Schema> &schema, Container &value, string_arena *arena)
+          : push_parser::basic_push_parser(arena), schema_(schema), value_(value) {}
+
+      private:
+      void read_begin() { value_.clear(); }
+
+      void read_item(reader &reader) { schema_.read_json_element(reader, value_); }
+
+      void read_end(reader &) {}
+
+      const array<Schema> &schema_;
+      Container &value_;
+
+      friend class basic_push_parser<push_parser, '[', ']'>;
+    };  // push_parser
+
+    /* max_json_size.
+
+       Schemas built only from `boolean`, `number`, `enumeration`, `optional`
+       and `object` have a longest possible output, known at compile time.
+       `string` and `array` do not, and leave `value` undefined. Keys are
+       assumed not to need escaping; if one does, `json_to` throws rather
+       than overrun. */
+
+    template <std::size_t N>
+    using size_constant = std::integral_constant<std::size_t, N>;
+
+    constexpr std::size_t sum(std::initializer_list<std::size_t> ns) {
+      std::size_t result = 0;
+      for (std::size_t n : ns) {
+        result += n;
+      }  // for
+      return result;
+    }
+
+    template <typename Arithmetic, typename E = void>
+    struct MaxNumberSize;
+
+    template <typename Integral>
+    struct MaxNumberSize<Integral, meta::if_<std::is_integral<Integral>>>
+        : size_constant<std::is_signed<Integral>{} +
+                        std::numeric_limits<Integral>::digits10 + 1> {};
+
+    template <typename Float>
+    struct MaxNumberSize<Float, meta::if_<std::is_floating_point<Float>>>
+        : size_constant<dtoa::max_length_for<Float>()> {};
+
+    template <typename Schema, typename T, typename E>
+    struct MaxJsonSize {};
+
+    template <>
+    struct MaxJsonSize<boolean, bool> : size_constant<5> {};
+
+    template <typename Enum>
+    struct MaxJsonSize<enumeration, Enum, meta::if_<std::is_enum<Enum>>>
+        : MaxNumberSize<std::underlying_type_t<Enum>> {};
+
+    template <typename Arithmetic>
+    struct MaxJsonSize<number,
+                       Arithmetic,
+                       meta::if_<std::is_arithmetic<Arithmetic>>>
+        : MaxNumberSize<decltype(std::declval<number>()
+                                     .json(std::declval<Arithmetic>())
+                                     .value_)> {};
+
+    template <typename Schema, typename Optional>
+    struct MaxJsonSize<optional<Schema>, Optional>
+        : size_constant<std::max<std::size_t>(
+              4,
+              MaxJsonSize<Schema,
+                          std::decay_t<decltype(
+                              *std::declval<const Optional &>())>>::value)> {};
+
+    template <typename Object,
+              typename Message,
+              typename... Schemas,
+              typename... Fs,
+              std::size_t... Lengths,
+              typename... Accessors>
+    struct MaxJsonSize<
+        object<Object, Message, field<Schemas, Fs, Lengths, Accessors>...>,
+        Object>
+        // `{` + `"name":value` + (`,"name":value`)... + `}`
+        : size_constant<1 + sum({(Lengths + 4 +
+                                  MaxJsonSize<Schemas,
+                                              member_t<Fs, Object>>::value)...})> {};
+
+    template <typename Object, typename Message, typename... Fields>
+    struct MaxJsonSize<object<Object, Message, Fields...>>
+        : MaxJsonSize<object<Object, Message, Fields...>, Object> {};
+
     #undef RETURN
 
   }  // namespace detail
@@ -642,15 +2393,42 @@ namespace jpc {
   constexpr detail::enumeration enumeration{};
   constexpr detail::number number{};
   constexpr detail::string string{};
+  constexpr detail::string_view string_view{};
 
   template <typename Schema>
   constexpr auto array(Schema schema) {
     return detail::array<Schema>{std::move(schema)};
   }
 
-  template <typename F, typename Schema>
-  constexpr auto field(Schema schema, F f, const char *name) {
-    return detail::field<Schema, F>{std::move(schema), std::move(f), name};
+  template <typename F, typename Schema, std::size_t N>
+  constexpr auto field(Schema schema, F f, const char (&name)[N]) {
+    return detail::field<Schema, F, N - 1>{
+        std::move(schema), std::move(f), name};
+  }
+
+  /* With the generated accessor of the field in the message, which
+     `protobuf` then calls directly instead of going through reflection:
+     the setter (`&FooInfo::set_b`) of a scalar or enum, or the `mutable_`
+     accessor (`&FooInfo::mutable_i`) of a string, message or repeated
+     field. */
+  template <typename F, typename Schema, std::size_t N, typename M, typename Arg>
+  constexpr auto field(Schema schema,
+                       F f,
+                       const char (&name)[N],
+                       void (M::*setter)(Arg)) {
+    return detail::field<Schema, F, N - 1, void (M::*)(Arg)>{
+        std::move(schema), std::move(f), name, setter};
+  }
+
+  // The `mutable_` accessor of a repeated field is overloaded with the one
+  // of an element; this picks the former.
+  template <typename F, typename Schema, std::size_t N, typename M, typename Field>
+  constexpr auto field(Schema schema,
+                       F f,
+                       const char (&name)[N],
+                       Field *(M::*mutable_field)()) {
+    return detail::field<Schema, F, N - 1, Field *(M::*)()>{
+        std::move(schema), std::move(f), name, mutable_field};
   }
 
   template <typename Schema>
@@ -658,15 +2436,177 @@ namespace jpc {
     return detail::optional<Schema>{std::move(schema)};
   }
 
+  /* writers */
+
+  using detail::basic_writer;
+  using detail::buffer;
+  using detail::parallel;
+#if JPC_POSIX
+  using detail::fd_writer;
+#endif
+  using detail::sink_writer;
+  using detail::span_writer;
+  using detail::string_writer;
+
+  /* readers */
+
+  using detail::parse_error;
+  using detail::parse_result;
+  using detail::string_arena;
+
+  template <typename T, typename Schema>
+  std::string to_string(const detail::json::string<T, Schema> &json) {
+    std::string result;
+    {
+      string_writer writer(result);
+      json.write(writer);
+    }
+    return result;
+  }
+
+  /* Newline-delimited JSON: one `schema.json(*first)` per line, written back
+     to back into `writer`. */
+
+  template <typename Schema, typename Iter, typename Writer>
+  void json_lines(const Schema &schema,
+                  Iter first,
+                  Iter last,
+                  basic_writer<Writer> &writer) {
+    for (; first != last; ++first) {
+      schema.json(*first).write(static_cast<Writer &>(writer));
+      writer.put('\n');
+    }  // for
+  }
+
+  /* As above, through one 64 KiB block handed to `sink(const char *,
+     std::size_t)` as it fills. */
+
+  template <typename Schema, typename Iter, typename Sink>
+  auto json_lines(const Schema &schema, Iter first, Iter last, Sink sink)
+      -> decltype(sink(std::declval<const char *>(), std::size_t{}), void()) {
+    auto writer = std::make_unique<sink_writer<Sink, 64 * 1024>>(std::move(sink));
+    json_lines(schema, std::move(first), std::move(last), *writer);
+    writer->flush();
+  }
+
+  /* The reverse: one `schema` value per line of `[first, last)` into
+     `out`, in order, skipping blank lines. `T` must be default
+     constructible.
+
+     With `policy`, the text is cut at line boundaries into tasks that
+     count their lines in parallel, and then parse them, again in
+     parallel, straight into their slots of `out`. A `parse_error` has the
+     line (from 1) and the offset into the whole text; of several bad
+     lines, it is the first. */
+
+  template <typename Schema, typename T>
+  void parse_json_lines(const Schema &schema,
+                        const char *first,
+                        const char *last,
+                        std::vector<T> &out,
+                        const parallel &policy = parallel(1)) {
+    // The end of the line at `p`, or `last`.
+    auto eol = [last](const char *p) {
+      const void *nl = std::memchr(p, '\n', static_cast<std::size_t>(last - p));
+      return nl ? static_cast<const char *>(nl) : last;
+    };
+    auto blank = [](const char *p, const char *q) {
+      for (; p != q; ++p) {
+        if (!detail::structural::is_ws(static_cast<unsigned char>(*p))) {
+          return false;
+        }  // if
+      }  // for
+      return true;
+    };
+    const auto size = static_cast<std::size_t>(last - first);
+    const std::size_t tasks = policy.tasks(size);
+    // Task `i` has the lines that start in `[cuts[i], cuts[i + 1])`.
+    std::vector<const char *> cuts(tasks + 1, last);
+    cuts[0] = first;
+    for (std::size_t i = 1; i < tasks; ++i) {
+      const char *p = std::max(cuts[i - 1], first + size / tasks * i);
+      if (p != first && p[-1] != '\n') {
+        p = eol(p);
+        p = p == last ? p : p + 1;
+      }  // if
+      cuts[i] = p;
+    }  // for
+    struct count {
+      std::size_t lines, values;
+    };
+    std::vector<count> counts(tasks + 1, count{0, 0});
+    detail::parallel_for(tasks, policy, [&](std::size_t i) {
+      for (const char *p = cuts[i]; p != cuts[i + 1];) {
+        const char *q = eol(p);
+        ++counts[i + 1].lines;
+        counts[i + 1].values += !blank(p, q);
+        p = q == last ? q : q + 1;
+      }  // for
+    });
+    for (std::size_t i = 1; i <= tasks; ++i) {
+      counts[i].lines += counts[i - 1].lines;
+      counts[i].values += counts[i - 1].values;
+    }  // for
+    out.clear();
+    out.resize(counts[tasks].values);
+    std::vector<std::exception_ptr> errors(tasks);
+    detail::parallel_for(tasks, policy, [&](std::size_t i) {
+      std::size_t line = counts[i].lines;
+      T *value = out.data() + counts[i].values;
+      try {
+        for (const char *p = cuts[i]; p != cuts[i + 1];) {
+          const char *q = eol(p);
+          ++line;
+          if (!blank(p, q)) {
+            detail::reader reader(p, q);
+            reader.start_at(static_cast<std::size_t>(p - first), line);
+            schema.read_json(reader, *value++);
+            reader.finish();
+          }  // if
+          p = q == last ? q : q + 1;
+        }  // for
+      } catch (const parse_error &) {
+        // Every task stops at its first error, and the earliest wins.
+        errors[i] = std::current_exception();
+      }  // try
+    });
+    for (const auto &error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }  // if
+    }  // for
+  }
+
+  template <typename Schema, typename T>
+  void parse_json_lines(const Schema &schema,
+                        const std::string &text,
+                        std::vector<T> &out,
+                        const parallel &policy = parallel(1)) {
+    parse_json_lines(schema, text.data(), text.data() + text.size(), out, policy);
+  }
+
   template <typename Object,
             typename Message,
             typename... Schemas,
-            typename... Fs>
-  constexpr auto object(detail::field<Schemas, Fs>... fields) {
-    return detail::object<Object, Message, detail::field<Schemas, Fs>...>{
+            typename... Fs,
+            std::size_t... Lengths,
+            typename... Accessors>
+  constexpr auto object(detail::field<Schemas, Fs, Lengths, Accessors>... fields) {
+    return detail::object<Object,
+                          Message,
+                          detail::field<Schemas, Fs, Lengths, Accessors>...>{
         std::move(fields)...};
   }
 
+  /* The longest JSON a bounded schema can produce, e.g.
+
+       std::array<char, jpc::max_json_size<decltype(schema)>> buffer;
+       std::size_t size = schema.json_to(value, buffer); */
+
+  template <typename Schema, typename T = void>
+  constexpr std::size_t max_json_size =
+      detail::MaxJsonSize<std::decay_t<Schema>, T>::value;
+
 }  // namespace jpc
 
 #endif  // JPC_HPP
@@ -0,0 +1,413 @@
+#ifndef DETAIL_DTOA_HPP
+#define DETAIL_DTOA_HPP
+
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+namespace jpc {
+
+  namespace detail {
+
+    namespace dtoa {
+
+      /* Shortest round-trip formatting of `double` and `float` (Grisu2, after
+         Florian Loitsch, "Printing Floating-Point Numbers Quickly and
+         Accurately with Integers", PLDI 2010).
+
+         The digits always parse back to the same value; they are the
+         shortest such digits for all but a tiny fraction of inputs. The
+         layout follows ECMAScript's `Number::toString`: `1.1`, `42`,
+         `0.000001`, `1e+21`, `1.5e-7`. */
+
+      /* diyfp: `f * 2^e`. */
+
+      struct diyfp {
+        uint64_t f;
+        int e;
+
+        static diyfp sub(const diyfp &x, const diyfp &y) {
+          assert(x.e == y.e && x.f >= y.f);
+          return {x.f - y.f, x.e};
+        }
+
+        /* Upper 64 bits of the 128-bit product, rounded. */
+        static diyfp mul(const diyfp &x, const diyfp &y) {
+          uint64_t u_lo = x.f & 0xFFFFFFFFu, u_hi = x.f >> 32;
+          uint64_t v_lo = y.f & 0xFFFFFFFFu, v_hi = y.f >> 32;
+          uint64_t p0 = u_lo * v_lo;
+          uint64_t p1 = u_lo * v_hi;
+          uint64_t p2 = u_hi * v_lo;
+          uint64_t p3 = u_hi * v_hi;
+          uint64_t q = (p0 >> 32) + (p1 & 0xFFFFFFFFu) + (p2 & 0xFFFFFFFFu);
+          q += uint64_t{1} << 31;
+          return {p3 + (p1 >> 32) + (p2 >> 32) + (q >> 32), x.e + y.e + 64};
+        }
+
+        static diyfp normalize(diyfp x) {
+          assert(x.f != 0);
+          while ((x.f >> 63) == 0) {
+            x.f <<= 1;
+            --x.e;
+          }  // while
+          return x;
+        }
+
+        static diyfp normalize_to(const diyfp &x, int e) {
+          assert(x.e >= e);
+          return {x.f << (x.e - e), e};
+        }
+      };  // diyfp
+
+      /* The normalized value `w` and its normalized boundaries `m-`, `m+`:
+         every real in `(m-, m+)` rounds to the input. */
+
+      struct boundaries {
+        diyfp w;
+        diyfp minus;
+        diyfp plus;
+      };
+
+      template <typename Float>
+      boundaries compute_boundaries(Float value) {
+        static_assert(std::numeric_limits<Float>::is_iec559, "");
+        constexpr int precision = std::numeric_limits<Float>::digits;
+        static_assert(precision == 24 || precision == 53, "");
+        constexpr int bias = std::numeric_limits<Float>::max_exponent - 1 +
+                             (precision - 1);
+        constexpr int min_exp = 1 - bias;
+        constexpr uint64_t hidden_bit = uint64_t{1} << (precision - 1);
+
+        using Bits = std::conditional_t<precision == 24, uint32_t, uint64_t>;
+        Bits bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+
+        uint64_t exponent = bits >> (precision - 1);
+        uint64_t fraction = bits & (hidden_bit - 1);
+
+        diyfp v = exponent == 0
+                      ? diyfp{fraction, min_exp}
+                      : diyfp{fraction + hidden_bit,
+                              static_cast<int>(exponent) - bias};
+
+        // The gap below a power of two is half the gap above it.
+        bool lower_is_closer = fraction == 0 && exponent > 1;
+        diyfp m_plus = {2 * v.f + 1, v.e - 1};
+        diyfp m_minus = lower_is_closer ? diyfp{4 * v.f - 1, v.e - 2}
+                                        : diyfp{2 * v.f - 1, v.e - 1};
+
+        diyfp w_plus = diyfp::normalize(m_plus);
+        diyfp w_minus = diyfp::normalize_to(m_minus, w_plus.e);
+        return {diyfp::normalize(v), w_minus, w_plus};
+      }
+
+      /* Cached powers `c_k ~= 10^k` for `k` in `[-300, 324]` in steps of 8,
+         so that some `w * c_k` lands with its binary exponent in
+         `[alpha, gamma]`. */
+
+      constexpr int alpha = -60;
+      constexpr int gamma = -32;
+
+      struct cached_power {
+        uint64_t f;
+        int e;
+        int k;
+      };
+
+      inline cached_power get_cached_power(int e) {
+        static constexpr cached_power cached_powers[] = {
+            {0xAB70FE17C79AC6CA, -1060, -300},
+            {0xFF77B1FCBEBCDC4F, -1034, -292},
+            {0xBE5691EF416BD60C, -1007, -284},
+            {0x8DD01FAD907FFC3C, -980, -276},
+            {0xD3515C2831559A83, -954, -268},
+            {0x9D71AC8FADA6C9B5, -927, -260},
+            {0xEA9C227723EE8BCB, -901, -252},
+            {0xAECC49914078536D, -874, -244},
+            {0x823C12795DB6CE57, -847, -236},
+            {0xC21094364DFB5637, -821, -228},
+            {0x9096EA6F3848984F, -794, -220},
+            {0xD77485CB25823AC7, -768, -212},
+            {0xA086CFCD97BF97F4, -741, -204},
+            {0xEF340A98172AACE5, -715, -196},
+            {0xB23867FB2A35B28E, -688, -188},
+            {0x84C8D4DFD2C63F3B, -661, -180},
+            {0xC5DD44271AD3CDBA, -635, -172},
+            {0x936B9FCEBB25C996, -608, -164},
+            {0xDBAC6C247D62A584, -582, -156},
+            {0xA3AB66580D5FDAF6, -555, -148},
+            {0xF3E2F893DEC3F126, -529, -140},
+            {0xB5B5ADA8AAFF80B8, -502, -132},
+            {0x87625F056C7C4A8B, -475, -124},
+            {0xC9BCFF6034C13053, -449, -116},
+            {0x964E858C91BA2655, -422, -108},
+            {0xDFF9772470297EBD, -396, -100},
+            {0xA6DFBD9FB8E5B88F, -369, -92},
+            {0xF8A95FCF88747D94, -343, -84},
+            {0xB94470938FA89BCF, -316, -76},
+            {0x8A08F0F8BF0F156B, -289, -68},
+            {0xCDB02555653131B6, -263, -60},
+            {0x993FE2C6D07B7FAC, -236, -52},
+            {0xE45C10C42A2B3B06, -210, -44},
+            {0xAA242499697392D3, -183, -36},
+            {0xFD87B5F28300CA0E, -157, -28},
+            {0xBCE5086492111AEB, -130, -20},
+            {0x8CBCCC096F5088CC, -103, -12},
+            {0xD1B71758E219652C, -77, -4},
+            {0x9C40000000000000, -50, 4},
+            {0xE8D4A51000000000, -24, 12},
+            {0xAD78EBC5AC620000, 3, 20},
+            {0x813F3978F8940984, 30, 28},
+            {0xC097CE7BC90715B3, 56, 36},
+            {0x8F7E32CE7BEA5C70, 83, 44},
+            {0xD5D238A4ABE98068, 109, 52},
+            {0x9F4F2726179A2245, 136, 60},
+            {0xED63A231D4C4FB27, 162, 68},
+            {0xB0DE65388CC8ADA8, 189, 76},
+            {0x83C7088E1AAB65DB, 216, 84},
+            {0xC45D1DF942711D9A, 242, 92},
+            {0x924D692CA61BE758, 269, 100},
+            {0xDA01EE641A708DEA, 295, 108},
+            {0xA26DA3999AEF774A, 322, 116},
+            {0xF209787BB47D6B85, 348, 124},
+            {0xB454E4A179DD1877, 375, 132},
+            {0x865B86925B9BC5C2, 402, 140},
+            {0xC83553C5C8965D3D, 428, 148},
+            {0x952AB45CFA97A0B3, 455, 156},
+            {0xDE469FBD99A05FE3, 481, 164},
+            {0xA59BC234DB398C25, 508, 172},
+            {0xF6C69A72A3989F5C, 534, 180},
+            {0xB7DCBF5354E9BECE, 561, 188},
+            {0x88FCF317F22241E2, 588, 196},
+            {0xCC20CE9BD35C78A5, 614, 204},
+            {0x98165AF37B2153DF, 641, 212},
+            {0xE2A0B5DC971F303A, 667, 220},
+            {0xA8D9D1535CE3B396, 694, 228},
+            {0xFB9B7CD9A4A7443C, 720, 236},
+            {0xBB764C4CA7A44410, 747, 244},
+            {0x8BAB8EEFB6409C1A, 774, 252},
+            {0xD01FEF10A657842C, 800, 260},
+            {0x9B10A4E5E9913129, 827, 268},
+            {0xE7109BFBA19C0C9D, 853, 276},
+            {0xAC2820D9623BF429, 880, 284},
+            {0x80444B5E7AA7CF85, 907, 292},
+            {0xBF21E44003ACDD2D, 933, 300},
+            {0x8E679C2F5E44FF8F, 960, 308},
+            {0xD433179D9C8CB841, 986, 316},
+            {0x9E19DB92B4E31BA9, 1013, 324},
+        };
+
+        constexpr int min_dec_exp = -300;
+        constexpr int dec_step = 8;
+
+        // k = ceil((alpha - e - 1) * log10(2))
+        int f = alpha - e - 1;
+        int k = (f * 78913) / (1 << 18) + static_cast<int>(f > 0);
+        int index = (-min_dec_exp + k + (dec_step - 1)) / dec_step;
+        assert(index >= 0 && index < 79);
+        const cached_power &cached = cached_powers[index];
+        assert(alpha <= cached.e + e + 64 && cached.e + e + 64 <= gamma);
+        return cached;
+      }
+
+      /* Number of decimal digits in `n`, with `pow10 = 10^(digits - 1)`. */
+
+      inline int find_largest_pow10(uint32_t n, uint32_t &pow10) {
+        static constexpr uint32_t pow10s[] = {1,
+                                              10,
+                                              100,
+                                              1000,
+                                              10000,
+                                              100000,
+                                              1000000,
+                                              10000000,
+                                              100000000,
+                                              1000000000};
+        int k = 9;
+        while (k > 0 && n < pow10s[k]) {
+          --k;
+        }  // while
+        pow10 = pow10s[k];
+        return k + 1;
+      }
+
+      /* Nudge the last digit towards `w` while staying inside `(M-, M+)`. */
+
+      inline void round(char *buffer,
+                        int length,
+                        uint64_t dist,
+                        uint64_t delta,
+                        uint64_t rest,
+                        uint64_t ten_k) {
+        while (rest < dist && delta - rest >= ten_k &&
+               (rest + ten_k < dist || dist - rest > rest + ten_k - dist)) {
+          --buffer[length - 1];
+          rest += ten_k;
+        }  // while
+      }
+
+      inline void generate_digits(char *buffer,
+                                  int &length,
+                                  int &decimal_exponent,
+                                  diyfp m_minus,
+                                  diyfp w,
+                                  diyfp m_plus) {
+        uint64_t delta = diyfp::sub(m_plus, m_minus).f;
+        uint64_t dist = diyfp::sub(m_plus, w).f;
+
+        // Split `M+` into integral part `p1` and fractional part `p2`.
+        const diyfp one = {uint64_t{1} << -m_plus.e, m_plus.e};
+        uint32_t p1 = static_cast<uint32_t>(m_plus.f >> -one.e);
+        uint64_t p2 = m_plus.f & (one.f - 1);
+
+        uint32_t pow10;
+        int n = find_largest_pow10(p1, pow10);
+        while (n > 0) {
+          buffer[length++] = static_cast<char>('0' + p1 / pow10);
+          p1 %= pow10;
+          --n;
+          uint64_t rest = (uint64_t{p1} << -one.e) + p2;
+          if (rest <= delta) {
+            decimal_exponent += n;
+            round(buffer, length, dist, delta, rest, uint64_t{pow10} << -one.e);
+            return;
+          }  // if
+          pow10 /= 10;
+        }  // while
+
+        int m = 0;
+        for (;;) {
+          p2 *= 10;
+          buffer[length++] = static_cast<char>('0' + (p2 >> -one.e));
+          p2 &= one.f - 1;
+          ++m;
+          delta *= 10;
+          dist *= 10;
+          if (p2 <= delta) {
+            break;
+          }  // if
+        }  // for
+        decimal_exponent -= m;
+        round(buffer, length, dist, delta, p2, one.f);
+      }
+
+      /* Writes the digits of `value > 0` into `buffer` (at most 17) such that
+         `value == digits * 10^decimal_exponent` after rounding. */
+
+      template <typename Float>
+      int grisu2(char *buffer, int &decimal_exponent, Float value) {
+        boundaries b = compute_boundaries(value);
+        cached_power cached = get_cached_power(b.plus.e);
+        diyfp c = {cached.f, cached.e};
+
+        diyfp w = diyfp::mul(b.w, c);
+        diyfp w_minus = diyfp::mul(b.minus, c);
+        diyfp w_plus = diyfp::mul(b.plus, c);
+
+        // Shrink by one unit on either side to absorb the rounding of `mul`.
+        diyfp m_minus = {w_minus.f + 1, w_minus.e};
+        diyfp m_plus = {w_plus.f - 1, w_plus.e};
+
+        int length = 0;
+        decimal_exponent = -cached.k;
+        generate_digits(buffer, length, decimal_exponent, m_minus, w, m_plus);
+        return length;
+      }
+
+      /* ECMAScript-style layout of `digits * 10^exponent`. */
+
+      inline char *format(char *first, int length, int exponent) {
+        const int point = length + exponent;
+        if (exponent >= 0 && point <= 21) {
+          // 1234e7 -> 12340000000
+          std::memset(first + length, '0', static_cast<std::size_t>(exponent));
+          return first + point;
+        }  // if
+        if (0 < point && point <= 21) {
+          // 1234e-2 -> 12.34
+          std::memmove(first + point + 1,
+                       first + point,
+                       static_cast<std::size_t>(length - point));
+          first[point] = '.';
+          return first + length + 1;
+        }  // if
+        if (-6 < point && point <= 0) {
+          // 1234e-6 -> 0.001234
+          std::memmove(first + 2 - point, first, static_cast<std::size_t>(length));
+          first[0] = '0';
+          first[1] = '.';
+          std::memset(first + 2, '0', static_cast<std::size_t>(-point));
+          return first + 2 - point + length;
+        }  // if
+        // 1234e30 -> 1.234e+33
+        char *last = first + 1;
+        if (length > 1) {
+          std::memmove(first + 2, first + 1, static_cast<std::size_t>(length - 1));
+          first[1] = '.';
+          last = first + length + 1;
+        }  // if
+        int e = point - 1;
+        *last++ = 'e';
+        *last++ = e < 0 ? '-' : '+';
+        e = e < 0 ? -e : e;
+        if (e >= 100) {
+          *last++ = static_cast<char>('0' + e / 100);
+          e %= 100;
+          *last++ = static_cast<char>('0' + e / 10);
+        } else if (e >= 10) {
+          *last++ = static_cast<char>('0' + e / 10);
+        }  // if
+        *last++ = static_cast<char>('0' + e % 10);
+        return last;
+      }
+
+      /* Longest output of `to_chars` for `Float`: the longest of
+         `-0.00000ddd`, `-ddd000` (21 integral digits) and `-d.ddde-ddd`, with
+         at most `max_digits10` digits. 25 for `double`, 22 for `float`. */
+
+      template <typename Float>
+      constexpr std::size_t max_length_for() {
+        constexpr std::size_t digits = std::numeric_limits<Float>::max_digits10;
+        constexpr std::size_t exponent_digits =
+            std::numeric_limits<Float>::max_exponent10 >= 100 ? 3 : 2;
+        std::size_t result = 2 + 5 + digits;
+        if (result < 21) {
+          result = 21;
+        }  // if
+        if (result < digits + 3 + exponent_digits) {
+          result = digits + 3 + exponent_digits;
+        }  // if
+        return 1 + result;
+      }
+
+      constexpr std::size_t max_length = max_length_for<double>();
+
+      /* Formats a finite `value` into `[first, first + max_length)` and
+         returns one past the last character written. */
+
+      template <typename Float>
+      char *to_chars(char *first, Float value) {
+        static_assert(std::is_floating_point<Float>{}, "");
+        if (std::signbit(value)) {
+          *first++ = '-';
+          value = -value;
+        }  // if
+        if (value == 0) {
+          *first++ = '0';
+          return first;
+        }  // if
+        int exponent;
+        int length = grisu2(first, exponent, value);
+        return format(first, length, exponent);
+      }
+
+    }  // namespace dtoa
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_DTOA_HPP
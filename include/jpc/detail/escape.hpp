@@ -0,0 +1,184 @@
+#ifndef DETAIL_ESCAPE_HPP
+#define DETAIL_ESCAPE_HPP
+
+#include <cstddef>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define JPC_X86 1
+#include <immintrin.h>
+#else
+#define JPC_X86 0
+#endif
+
+namespace jpc {
+
+  namespace detail {
+
+    namespace escape {
+
+      /* JSON string escaping.
+
+         Most strings need no escaping at all, so the work is in finding the
+         next byte that does: `"`, `\` or a control character below 0x20.
+         The scanners below check 16 (SSE2) or 32 (AVX2) bytes per step and
+         the clean run in between is copied with a single `write`. The AVX2
+         scanner is picked at runtime; everything else falls back to a
+         scalar loop. Bytes >= 0x80 pass through, so UTF-8 stays as is. */
+
+      inline bool needs_escape(unsigned char c) {
+        return c < 0x20 || c == '"' || c == '\\';
+      }
+
+      inline const char *find_scalar(const char *first, const char *last) {
+        while (first != last &&
+               !needs_escape(static_cast<unsigned char>(*first))) {
+          ++first;
+        }  // while
+        return first;
+      }
+
+#if JPC_X86
+      inline __m128i needs_escape(__m128i v) {
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i control = _mm_set1_epi8(0x1F);
+        // `v <= 0x1F` as unsigned bytes is `min(v, 0x1F) == v`.
+        return _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, quote),
+                         _mm_cmpeq_epi8(v, backslash)),
+            _mm_cmpeq_epi8(_mm_min_epu8(v, control), v));
+      }
+
+      inline const char *find_sse2(const char *first, const char *last) {
+        while (last - first >= 16) {
+          __m128i v =
+              _mm_loadu_si128(reinterpret_cast<const __m128i *>(first));
+          int mask = _mm_movemask_epi8(needs_escape(v));
+          if (mask) {
+            return first + __builtin_ctz(static_cast<unsigned>(mask));
+          }  // if
+          first += 16;
+        }  // while
+        return find_scalar(first, last);
+      }
+
+      __attribute__((target("avx2")))
+      inline const char *find_avx2(const char *first, const char *last) {
+        const __m256i quote = _mm256_set1_epi8('"');
+        const __m256i backslash = _mm256_set1_epi8('\\');
+        const __m256i control = _mm256_set1_epi8(0x1F);
+        while (last - first >= 32) {
+          __m256i v =
+              _mm256_loadu_si256(reinterpret_cast<const __m256i *>(first));
+          __m256i escape = _mm256_or_si256(
+              _mm256_or_si256(_mm256_cmpeq_epi8(v, quote),
+                              _mm256_cmpeq_epi8(v, backslash)),
+              _mm256_cmpeq_epi8(_mm256_min_epu8(v, control), v));
+          unsigned mask =
+              static_cast<unsigned>(_mm256_movemask_epi8(escape));
+          if (mask) {
+            return first + __builtin_ctz(mask);
+          }  // if
+          first += 32;
+        }  // while
+        return find_sse2(first, last);
+      }
+#endif
+
+      /* Returns the first byte in `[first, last)` that needs escaping. */
+
+      using find_fn = const char *(*)(const char *, const char *);
+
+      inline find_fn select_find() {
+#if JPC_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+          return find_avx2;
+        }  // if
+        return find_sse2;
+#else
+        return find_scalar;
+#endif
+      }
+
+      inline const char *find(const char *first, const char *last) {
+        static const find_fn impl = select_find();
+        return impl(first, last);
+      }
+
+      /* The escape sequence for `c`, where `needs_escape(c)`. */
+
+      template <typename Writer>
+      void write_escape(Writer &writer, unsigned char c) {
+        static constexpr char hex[] = "0123456789abcdef";
+        char *first = writer.prepare(6);
+        first[0] = '\\';
+        switch (c) {
+          case '"': first[1] = '"'; break;
+          case '\\': first[1] = '\\'; break;
+          case '\b': first[1] = 'b'; break;
+          case '\f': first[1] = 'f'; break;
+          case '\n': first[1] = 'n'; break;
+          case '\r': first[1] = 'r'; break;
+          case '\t': first[1] = 't'; break;
+          default:
+            first[1] = 'u';
+            first[2] = '0';
+            first[3] = '0';
+            first[4] = hex[c >> 4];
+            first[5] = hex[c & 0xF];
+            writer.commit(first + 6);
+            return;
+        }  // switch
+        writer.commit(first + 2);
+      }
+
+      /* Writes `[first, last)` escaped, without the surrounding quotes. */
+
+      template <typename Writer>
+      void write(Writer &writer, const char *first, const char *last) {
+        for (;;) {
+          const char *p = find(first, last);
+          writer.write(first, static_cast<std::size_t>(p - first));
+          if (p == last) {
+            return;
+          }  // if
+          write_escape(writer, static_cast<unsigned char>(*p));
+          first = p + 1;
+        }  // for
+      }
+
+      /* The number of bytes `write` produces for `[first, last)`. */
+
+      inline std::size_t size(const char *first, const char *last) {
+        std::size_t result = static_cast<std::size_t>(last - first);
+        for (;;) {
+          const char *p = find(first, last);
+          if (p == last) {
+            return result;
+          }  // if
+          switch (*p) {
+            case '"':
+            case '\\':
+            case '\b':
+            case '\f':
+            case '\n':
+            case '\r':
+            case '\t':
+              result += 1;
+              break;
+            default:
+              result += 5;
+              break;
+          }  // switch
+          first = p + 1;
+        }  // for
+      }
+
+    }  // namespace escape
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_ESCAPE_HPP
@@ -0,0 +1,174 @@
+#ifndef DETAIL_ITOA_HPP
+#define DETAIL_ITOA_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace jpc {
+
+  namespace detail {
+
+    namespace itoa {
+
+      /* Integer to decimal, written straight into the output. The digit
+         count comes from the leading-zero count, so each number is written
+         back to front into exactly as many bytes as it needs, two digits per
+         table lookup. */
+
+      /* Longest output, `-9223372036854775808`. */
+      constexpr std::size_t max_length = 20;
+
+      inline const char *digit_pairs() {
+        static constexpr char pairs[] =
+            "0001020304050607080910111213141516171819"
+            "2021222324252627282930313233343536373839"
+            "4041424344454647484950515253545556575859"
+            "6061626364656667686970717273747576777879"
+            "8081828384858687888990919293949596979899";
+        return pairs;
+      }
+
+      inline int bit_width(uint32_t n) {
+#if defined(__GNUC__)
+        return 32 - __builtin_clz(n | 1);
+#else
+        int result = 1;
+        while (n >>= 1) {
+          ++result;
+        }  // while
+        return result;
+#endif
+      }
+
+      inline int bit_width(uint64_t n) {
+#if defined(__GNUC__)
+        return 64 - __builtin_clzll(n | 1);
+#else
+        int result = 1;
+        while (n >>= 1) {
+          ++result;
+        }  // while
+        return result;
+#endif
+      }
+
+      /* `floor(log10(2^bits))` is `bits * 1233 >> 12`, which is either the
+         digit count or one over it. */
+
+      inline int count_digits(uint32_t n) {
+        static constexpr uint32_t pow10s[] = {
+            0, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000,
+            1000000000};
+        int t = bit_width(n) * 1233 >> 12;
+        return t - (n < pow10s[t]) + 1;
+      }
+
+      inline int count_digits(uint64_t n) {
+        static constexpr uint64_t pow10s[] = {0,
+                                              10,
+                                              100,
+                                              1000,
+                                              10000,
+                                              100000,
+                                              1000000,
+                                              10000000,
+                                              100000000,
+                                              1000000000,
+                                              10000000000,
+                                              100000000000,
+                                              1000000000000,
+                                              10000000000000,
+                                              100000000000000,
+                                              1000000000000000,
+                                              10000000000000000,
+                                              100000000000000000,
+                                              1000000000000000000,
+                                              10000000000000000000u};
+        int t = bit_width(n) * 1233 >> 12;
+        return t - (n < pow10s[t]) + 1;
+      }
+
+      /* Writes the digits of `n` ending at `last`. */
+
+      template <typename Unsigned>
+      void write_backward(char *last, Unsigned n) {
+        const char *pairs = digit_pairs();
+        while (n >= 100) {
+          last -= 2;
+          std::memcpy(last, pairs + (n % 100) * 2, 2);
+          n /= 100;
+        }  // while
+        if (n >= 10) {
+          std::memcpy(last - 2, pairs + n * 2, 2);
+        } else {
+          last[-1] = static_cast<char>('0' + n);
+        }  // if
+      }
+
+      inline char *to_chars(char *first, uint32_t n) {
+        char *last = first + count_digits(n);
+        write_backward(last, n);
+        return last;
+      }
+
+      inline char *to_chars(char *first, uint64_t n) {
+        if (n <= UINT32_MAX) {
+          return to_chars(first, static_cast<uint32_t>(n));
+        }  // if
+        char *last = first + count_digits(n);
+        // Peel 8 digits at a time so that the rest runs on 32-bit divisions.
+        char *mid = last;
+        while (n > UINT32_MAX) {
+          uint32_t low = static_cast<uint32_t>(n % 100000000);
+          n /= 100000000;
+          mid -= 8;
+          std::memset(mid, '0', 8);
+          if (low) {
+            write_backward(mid + 8, low);
+          }  // if
+        }  // while
+        write_backward(mid, static_cast<uint32_t>(n));
+        return last;
+      }
+
+      inline char *to_chars(char *first, int32_t n) {
+        uint32_t u = static_cast<uint32_t>(n);
+        if (n < 0) {
+          *first++ = '-';
+          u = 0u - u;
+        }  // if
+        return to_chars(first, u);
+      }
+
+      inline char *to_chars(char *first, int64_t n) {
+        uint64_t u = static_cast<uint64_t>(n);
+        if (n < 0) {
+          *first++ = '-';
+          u = 0u - u;
+        }  // if
+        return to_chars(first, u);
+      }
+
+      /* The number of bytes `to_chars` writes. */
+
+      inline std::size_t size(uint32_t n) { return count_digits(n); }
+      inline std::size_t size(uint64_t n) { return count_digits(n); }
+
+      inline std::size_t size(int32_t n) {
+        uint32_t u = static_cast<uint32_t>(n);
+        return n < 0 ? 1 + size(0u - u) : size(u);
+      }
+
+      inline std::size_t size(int64_t n) {
+        uint64_t u = static_cast<uint64_t>(n);
+        return n < 0 ? 1 + size(0u - u) : size(u);
+      }
+
+    }  // namespace itoa
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_ITOA_HPP
@@ -0,0 +1,180 @@
+#ifndef DETAIL_PARALLEL_HPP
+#define DETAIL_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace jpc {
+
+  namespace detail {
+
+    /* thread_pool: `threads - 1` workers, started once, that join the
+       calling thread in every `run` until the pool is destroyed. */
+
+    class thread_pool {
+      public:
+      explicit thread_pool(std::size_t threads) {
+        workers_.reserve(threads - 1);
+        for (std::size_t i = 1; i < threads; ++i) {
+          try {
+            workers_.emplace_back([this] { loop(); });
+          } catch (const std::system_error &) {
+            break;  // Carry on with the threads we have.
+          }  // try
+        }  // for
+      }
+
+      thread_pool(const thread_pool &) = delete;
+      thread_pool &operator=(const thread_pool &) = delete;
+
+      ~thread_pool() {
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto &worker : workers_) {
+          worker.join();
+        }  // for
+      }
+
+      /* Runs `work()`, which must not throw, on every worker and on the
+         caller, and returns once all of them have returned. While the pool
+         is busy (with another caller's work, or from inside `work`), the
+         caller runs `work()` alone. */
+      template <typename F>
+      void run(F &work) {
+        if (workers_.empty() || running_.exchange(true)) {
+          work();
+          return;
+        }  // if
+        {
+          std::lock_guard<std::mutex> lock(mutex_);
+          work_ = &work;
+          call_ = [](void *work) { (*static_cast<F *>(work))(); };
+          busy_ = workers_.size();
+          ++generation_;
+        }
+        wake_.notify_all();
+        work();
+        {
+          std::unique_lock<std::mutex> lock(mutex_);
+          done_.wait(lock, [this] { return busy_ == 0; });
+        }
+        running_.store(false);
+      }
+
+      private:
+      void loop() {
+        std::size_t generation = 0;
+        std::unique_lock<std::mutex> lock(mutex_);
+        for (;;) {
+          wake_.wait(lock, [&] { return stop_ || generation_ != generation; });
+          if (stop_) {
+            return;
+          }  // if
+          generation = generation_;
+          void (*call)(void *) = call_;
+          void *work = work_;
+          lock.unlock();
+          call(work);
+          lock.lock();
+          if (--busy_ == 0) {
+            done_.notify_one();
+          }  // if
+        }  // for
+      }
+
+      std::vector<std::thread> workers_;
+      std::atomic<bool> running_{false};
+      std::mutex mutex_;
+      std::condition_variable wake_;
+      std::condition_variable done_;
+      void (*call_)(void *) = nullptr;
+      void *work_ = nullptr;
+      std::size_t generation_ = 0;
+      std::size_t busy_ = 0;
+      bool stop_ = false;
+    };  // thread_pool
+
+    /* parallel: opts a bulk operation into running on `threads` threads
+       (the calling thread included), in tasks of at least `grain`
+       elements. Ranges too small to split run serially.
+
+       The other `threads - 1` are started here and reused by every
+       operation the policy is passed to, so keep it around rather than
+       constructing one per call. Copies share the threads. */
+
+    struct parallel {
+      explicit parallel(std::size_t threads = std::thread::hardware_concurrency(),
+                        std::size_t grain = 1024)
+          : threads_(std::max<std::size_t>(threads, 1)),
+            grain_(std::max<std::size_t>(grain, 1)),
+            pool_(threads_ > 1 ? std::make_shared<thread_pool>(threads_) : nullptr) {}
+
+      /* The number of tasks to cut `n` elements into: a few per thread for
+         load balance, none smaller than `grain`. */
+      std::size_t tasks(std::size_t n) const {
+        if (threads_ == 1) {
+          return 1;
+        }  // if
+        return std::max<std::size_t>(
+            1, std::min(n / grain_, threads_ * 4));
+      }
+
+      std::size_t threads_;
+      std::size_t grain_;
+      std::shared_ptr<thread_pool> pool_;
+    };  // parallel
+
+    /* Runs `f(i)` for every `i` in `[0, n)`, handing out indices in order
+       to `policy`'s threads (the caller is one of them). The first
+       exception thrown is rethrown once all threads are done. */
+
+    template <typename F>
+    void parallel_for(std::size_t n, const parallel &policy, F &&f) {
+      if (n <= 1 || !policy.pool_) {
+        for (std::size_t i = 0; i < n; ++i) {
+          f(i);
+        }  // for
+        return;
+      }  // if
+      std::atomic<std::size_t> next{0};
+      std::exception_ptr error;
+      std::mutex mutex;
+      auto work = [&] {
+        for (;;) {
+          std::size_t i = next.fetch_add(1, std::memory_order_relaxed);
+          if (i >= n) {
+            return;
+          }  // if
+          try {
+            f(i);
+          } catch (...) {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!error) {
+              error = std::current_exception();
+            }  // if
+            next.store(n, std::memory_order_relaxed);
+          }  // try
+        }  // for
+      };
+      policy.pool_->run(work);
+      if (error) {
+        std::rethrow_exception(error);
+      }  // if
+    }
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_PARALLEL_HPP
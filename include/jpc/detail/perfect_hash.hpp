@@ -0,0 +1,168 @@
+#ifndef DETAIL_PERFECT_HASH_HPP
+#define DETAIL_PERFECT_HASH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace jpc {
+
+  namespace detail {
+
+    /* perfect_hash: maps a fixed set of keys (an object's field names) to
+       their indices with two table lookups and one verifying compare.
+
+       It is hash-and-displace: a key's 64-bit hash picks a bucket, and each
+       bucket has a displacement, searched for when the table is built, that
+       sends all of its keys to distinct free slots. Buckets are placed
+       largest first, so with twice as many slots as keys every displacement
+       is found within a few tries. */
+
+    class perfect_hash {
+      public:
+      static constexpr std::size_t npos = std::numeric_limits<std::size_t>::max();
+
+      perfect_hash() = default;
+
+      explicit perfect_hash(std::vector<std::pair<const char *, std::size_t>> keys)
+          : keys_(std::move(keys)) {
+        std::size_t n = keys_.size();
+        std::size_t buckets = 1;
+        while (buckets < n) {
+          buckets *= 2;
+        }  // while
+        std::size_t slots = 2 * buckets;
+        bucket_mask_ = buckets - 1;
+        slot_mask_ = slots - 1;
+        displacements_.assign(buckets, 0);
+        slots_.assign(slots, uint32_t{empty});
+
+        std::vector<std::vector<uint32_t>> members(buckets);
+        for (std::size_t i = 0; i < n; ++i) {
+          for (std::size_t j = 0; j < i; ++j) {
+            if (keys_[i].second == keys_[j].second &&
+                std::memcmp(keys_[i].first, keys_[j].first, keys_[i].second) == 0) {
+              throw std::runtime_error("duplicate field name");
+            }  // if
+          }  // for
+          members[bucket(hash(keys_[i].first, keys_[i].second))].push_back(
+              static_cast<uint32_t>(i));
+        }  // for
+        std::vector<std::size_t> order(buckets);
+        for (std::size_t b = 0; b < buckets; ++b) {
+          order[b] = b;
+        }  // for
+        std::stable_sort(order.begin(), order.end(), [&](std::size_t l, std::size_t r) {
+          return members[l].size() > members[r].size();
+        });
+        std::vector<std::size_t> placed;
+        for (std::size_t b : order) {
+          if (members[b].empty()) {
+            break;
+          }  // if
+          for (uint32_t d = 0;; ++d) {
+            if (d == (1u << 24)) {
+              throw std::runtime_error("no perfect hash for the field names");
+            }  // if
+            placed.clear();
+            for (uint32_t i : members[b]) {
+              std::size_t s = slot(hash(keys_[i].first, keys_[i].second), d);
+              if (slots_[s] != empty) {
+                break;
+              }  // if
+              slots_[s] = i;
+              placed.push_back(s);
+            }  // for
+            if (placed.size() == members[b].size()) {
+              displacements_[b] = d;
+              break;
+            }  // if
+            for (std::size_t s : placed) {
+              slots_[s] = empty;
+            }  // for
+          }  // for
+        }  // for
+      }
+
+      /* The index of `[key, key + size)`, or `npos`. */
+      std::size_t find(const char *key, std::size_t size) const {
+        if (keys_.empty()) {
+          return npos;
+        }  // if
+        uint64_t h = hash(key, size);
+        uint32_t i = slots_[slot(h, displacements_[bucket(h)])];
+        if (i == empty || keys_[i].second != size ||
+            std::memcmp(keys_[i].first, key, size) != 0) {
+          return npos;
+        }  // if
+        return i;
+      }
+
+      private:
+      static constexpr uint32_t empty = std::numeric_limits<uint32_t>::max();
+      static constexpr uint64_t k = 0x9E3779B97F4A7C15;
+
+      /* 8 bytes at a time, so typical field names take one or two rounds. */
+      static uint64_t hash(const char *key, std::size_t size) {
+        uint64_t h = mix(size + k);
+        for (; size >= 8; key += 8, size -= 8) {
+          uint64_t word;
+          std::memcpy(&word, key, 8);
+          h = mix(h ^ word);
+        }  // for
+        if (size) {
+          h = mix(h ^ load_tail(key, size));
+        }  // if
+        return h;
+      }
+
+      /* The 64-bit finalizer from MurmurHash3: every input bit flips each
+         output bit with probability about 1/2. */
+      static uint64_t mix(uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xFF51AFD7ED558CCD;
+        x ^= x >> 33;
+        x *= 0xC4CEB9FE1A85EC53;
+        x ^= x >> 33;
+        return x;
+      }
+
+      /* The last `0 < size < 8` bytes as one word, with fixed-size loads
+         only (overlapping when need be); `size` is hashed separately. */
+      static uint64_t load_tail(const char *key, std::size_t size) {
+        if (size >= 4) {
+          uint32_t low, high;
+          std::memcpy(&low, key, 4);
+          std::memcpy(&high, key + size - 4, 4);
+          return low | uint64_t{high} << 32;
+        }  // if
+        return uint64_t{static_cast<unsigned char>(key[0])} |
+               uint64_t{static_cast<unsigned char>(key[size / 2])} << 8 |
+               uint64_t{static_cast<unsigned char>(key[size - 1])} << 16;
+      }
+
+      std::size_t bucket(uint64_t h) const {
+        return static_cast<std::size_t>(h >> 40) & bucket_mask_;
+      }
+
+      std::size_t slot(uint64_t h, uint32_t d) const {
+        return static_cast<std::size_t>(mix(h + uint64_t{d} * k)) & slot_mask_;
+      }
+
+      std::vector<std::pair<const char *, std::size_t>> keys_;
+      std::vector<uint32_t> displacements_;
+      std::vector<uint32_t> slots_;
+      std::size_t bucket_mask_ = 0;
+      std::size_t slot_mask_ = 0;
+    };  // perfect_hash
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_PERFECT_HASH_HPP
@@ -0,0 +1,215 @@
+#ifndef DETAIL_PUSH_PARSER_HPP
+#define DETAIL_PUSH_PARSER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <jpc/detail/escape.hpp>
+#include <jpc/detail/reader.hpp>
+#include <jpc/detail/structural.hpp>
+
+namespace jpc {
+
+  namespace detail {
+
+    /* basic_push_parser: parses a top-level JSON object or array that
+       arrives in chunks of any size, e.g. as read off a socket.
+
+       A resumable scanner follows strings and brackets across chunks to
+       find where each member (or element) of the container ends, and each
+       one is read into the target as soon as it is complete. Only the
+       unfinished member is buffered, never the whole document; partial
+       tokens simply stay in that buffer until the rest arrives.
+
+       `Derived` reads the pieces: `read_begin()` at the opening bracket,
+       `read_item(reader &)` for each member or element, and
+       `read_end(reader &)` at the closing bracket. Errors are
+       `parse_error`s with offsets into the whole input, after which the
+       parser is unusable. */
+
+    template <typename Derived, char Open, char Close>
+    class basic_push_parser {
+      public:
+      /* Reads every member the chunk completes and keeps the rest. */
+      void feed(const char *first, const char *last) {
+        first = scan(first, last);
+        pending_.append(first, last);
+      }
+
+      void feed(const std::string &chunk) {
+        feed(chunk.data(), chunk.data() + chunk.size());
+      }
+
+      /* The input is over: throws unless the container is complete. */
+      void finish() const {
+        switch (stage_) {
+          case stage::before:
+            throw parse_error(std::string("expected '") + Open + '\'',
+                              offset_ + pending_.size());
+          case stage::inside:
+            throw parse_error("unterminated value", offset_ + pending_.size());
+          case stage::after:
+            return;
+        }  // switch
+      }
+
+      bool done() const { return stage_ == stage::after; }
+
+      protected:
+      explicit basic_push_parser(string_arena *arena) : arena_(arena) {}
+
+      private:
+      enum class stage { before, inside, after };
+
+      Derived &derived() { return static_cast<Derived &>(*this); }
+
+      /* Scans a chunk, reads each member that ends in it, and returns
+         where the new unfinished one starts. An unfinished member is
+         `pending_` followed by `[first, p)`.
+
+         Inside the container, whole 64-byte blocks go through the
+         `structural` classifier, which carries the in-string and escape
+         state between blocks just as this loop does between chunks; the
+         rest is scanned a byte at a time. */
+      const char *scan(const char *first, const char *last) {
+        static const structural::classify_fn classify = structural::select_classify();
+        const char *p = first;
+        while (p != last) {
+          if (stage_ == stage::inside && last - p >= 64) {
+            structural::carry carry;
+            carry.escaped = escaped_;
+            carry.in_string = in_string_ ? ~uint64_t{0} : 0;
+            const structural::masks masks = classify(p);
+            uint64_t ops = structural::find(masks, carry) & masks.op;
+            in_string_ = carry.in_string != 0;
+            escaped_ = carry.escaped != 0;
+            const char *block = p;
+            p += 64;
+            for (; ops; ops &= ops - 1) {
+              const char *op = block + __builtin_ctzll(ops);
+              first = structure(first, op);
+              if (stage_ != stage::inside) {
+                // The rest of the block is after the container.
+                p = op + 1;
+                break;
+              }  // if
+            }  // for
+            continue;
+          }  // if
+          auto c = static_cast<unsigned char>(*p);
+          if (stage_ != stage::inside) {
+            if (structural::is_ws(c)) {
+              first = advance(first, p + 1);
+            } else if (stage_ == stage::after || c != Open) {
+              fail(first, p, stage_ == stage::after
+                                 ? std::string("trailing characters")
+                                 : std::string("expected '") + Open + '\'');
+            } else {
+              stage_ = stage::inside;
+              derived().read_begin();
+              first = advance(first, p + 1);
+            }  // if
+          } else if (in_string_) {
+            if (escaped_) {
+              escaped_ = false;
+            } else if (c == '\\') {
+              escaped_ = true;
+            } else if (c == '"') {
+              in_string_ = false;
+            } else {
+              // On to the next byte that may end the string.
+              p = escape::find(p + 1, last);
+              continue;
+            }  // if
+          } else if (c == '"') {
+            in_string_ = true;
+          } else if (structural::is_op(c)) {
+            first = structure(first, p);
+          }  // if
+          ++p;
+        }  // while
+        return first;
+      }
+
+      /* Handles `{ } [ ] : ,` at `p` outside strings, reading the member it
+         ends, if any, and returns where the unfinished member starts. */
+      const char *structure(const char *first, const char *p) {
+        char c = *p;
+        if (c == '{' || c == '[') {
+          ++depth_;
+        } else if (depth_ != 0) {
+          depth_ -= c == '}' || c == ']';
+        } else if (c == ',' || c == Close) {
+          if (!pending_.empty()) {
+            // The member started in an earlier chunk.
+            pending_.append(first, p);
+            first = p;
+          }  // if
+          const char *item = pending_.empty() ? first : pending_.data();
+          const char *item_last = pending_.empty() ? p : item + pending_.size();
+          if (c == ',' || items_ != 0 || !blank(item, item_last)) {
+            read(item, item_last, [&](reader &reader) { derived().read_item(reader); });
+            ++items_;
+          }  // if
+          first = advance(first, p + 1);
+          if (c == Close) {
+            stage_ = stage::after;
+            read(first, first, [&](reader &reader) { derived().read_end(reader); });
+          }  // if
+        } else if (c == '}' || c == ']') {
+          fail(first, p, std::string("expected '") + Close + '\'');
+        }  // if
+        return first;
+      }
+
+      /* Reads `[first, last)`, which is at `offset_` in the whole input,
+         as exactly one piece. */
+      template <typename F>
+      void read(const char *first, const char *last, F f) {
+        reader reader(first, last);
+        reader.start_at(offset_);
+        // Chunks come and go, so `string_view`s cannot borrow from them.
+        reader.use_arena(arena_, false);
+        f(reader);
+        reader.finish();
+      }
+
+      /* Starts the unfinished member at `next` instead. */
+      const char *advance(const char *first, const char *next) {
+        offset_ += pending_.size() + static_cast<std::size_t>(next - first);
+        pending_.clear();
+        return next;
+      }
+
+      [[noreturn]] void fail(const char *first,
+                             const char *p,
+                             const std::string &what) const {
+        throw parse_error(what, offset_ + pending_.size() +
+                                    static_cast<std::size_t>(p - first));
+      }
+
+      static bool blank(const char *first, const char *last) {
+        for (; first != last; ++first) {
+          if (!structural::is_ws(static_cast<unsigned char>(*first))) {
+            return false;
+          }  // if
+        }  // for
+        return true;
+      }
+
+      string_arena *arena_;
+      std::string pending_;
+      std::size_t offset_ = 0;  // Of the unfinished member in the input.
+      stage stage_ = stage::before;
+      std::size_t depth_ = 0;   // Of brackets inside the member.
+      std::size_t items_ = 0;
+      bool in_string_ = false;
+      bool escaped_ = false;
+    };  // basic_push_parser
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_PUSH_PARSER_HPP
@@ -0,0 +1,593 @@
+#ifndef DETAIL_READER_HPP
+#define DETAIL_READER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <jpc/detail/atof.hpp>
+#include <jpc/detail/escape.hpp>
+#include <jpc/detail/structural.hpp>
+
+namespace jpc {
+
+  namespace detail {
+
+    /* parse_error: what went wrong, and where, as a byte offset into the
+       input and, for newline-delimited input, the line (from 1). */
+
+    class parse_error : public std::runtime_error {
+      public:
+      parse_error(const std::string &what, std::size_t offset, std::size_t line = 0)
+          : std::runtime_error(
+                what + (line ? " on line " + std::to_string(line) : "") +
+                " at offset " + std::to_string(offset)),
+            offset_(offset),
+            line_(line) {}
+
+      std::size_t offset() const { return offset_; }
+
+      /* 0 unless the input was read a line at a time. */
+      std::size_t line() const { return line_; }
+
+      private:
+      std::size_t offset_;
+      std::size_t line_;
+    };  // parse_error
+
+    /* parse_result: what a parse did besides filling in the object. */
+
+    struct parse_result {
+      // Bytes of members under keys the schema does not declare, passed
+      // over without being decoded.
+      std::size_t skipped;
+    };  // parse_result
+
+    /* string_arena: owns the unescaped copies of strings read into
+       `string_view` fields that had escapes, for as long as the views
+       into it live. Strings without escapes are borrowed from the input
+       and never land here. */
+
+    class string_arena {
+      public:
+      /* Moves `s` in; the characters stay put until `clear`. */
+      const std::string &keep(std::string s) {
+        strings_.push_back(std::move(s));
+        return strings_.back();
+      }
+
+      std::size_t size() const { return strings_.size(); }
+
+      void clear() { strings_.clear(); }
+
+      private:
+      std::deque<std::string> strings_;
+    };  // string_arena
+
+    /* reader: a cursor over JSON text for the schema-driven parsers.
+
+       The schema says what comes next, so there is no generic value type:
+       each `read_*` consumes exactly one token of the expected kind (after
+       any whitespace) or throws a `parse_error`. */
+
+    class reader {
+      public:
+      reader(const char *first, const char *last)
+          : first_(first), cur_(first), last_(last) {}
+
+      reader(const reader &) = delete;
+      reader &operator=(const reader &) = delete;
+
+      /* Where `read_string_view` keeps strings it had to unescape; with
+         `borrow` off, it keeps every string there, for input that will
+         not outlive the views. */
+      void use_arena(string_arena *arena, bool borrow = true) {
+        arena_ = arena;
+        borrow_ = borrow;
+      }
+
+      /* Offsets count from `offset` rather than 0, for input that is a
+         piece of a larger text, e.g. its `line`. */
+      void start_at(std::size_t offset, std::size_t line = 0) {
+        base_ = offset;
+        line_ = line;
+      }
+
+      std::size_t offset() const {
+        return base_ + static_cast<std::size_t>(cur_ - first_);
+      }
+
+      [[noreturn]] void fail(const std::string &what) const {
+        throw parse_error(what, offset(), line_);
+      }
+
+      /* The next non-whitespace byte, or `'\0'` at the end. */
+      char peek() {
+        while (cur_ != last_ && structural::is_ws(static_cast<unsigned char>(*cur_))) {
+          ++cur_;
+        }  // while
+        return cur_ == last_ ? '\0' : *cur_;
+      }
+
+      bool consume(char c) {
+        if (peek() != c) {
+          return false;
+        }  // if
+        ++cur_;
+        return true;
+      }
+
+      void expect(char c) {
+        if (!consume(c)) {
+          fail(std::string("expected '") + c + '\'');
+        }  // if
+      }
+
+      /* Consumes `null`, `true` or `false` if it is next. */
+      template <std::size_t N>
+      bool consume_literal(const char (&literal)[N]) {
+        if (peek() != literal[0]) {
+          return false;
+        }  // if
+        if (static_cast<std::size_t>(last_ - cur_) < N - 1 ||
+            std::memcmp(cur_, literal, N - 1) != 0) {
+          fail("invalid literal");
+        }  // if
+        cur_ += N - 1;
+        return true;
+      }
+
+      /* Only whitespace may follow the top-level value. */
+      void finish() {
+        if (peek() != '\0' || cur_ != last_) {
+          fail("trailing characters");
+        }  // if
+      }
+
+      bool read_bool() {
+        if (consume_literal("true")) {
+          return true;
+        }  // if
+        if (consume_literal("false")) {
+          return false;
+        }  // if
+        fail("expected a boolean");
+      }
+
+      /* Integers have no fraction or exponent and must fit `Integral`. */
+      template <typename Integral>
+      Integral read_integer() {
+        static_assert(std::is_integral<Integral>{}, "");
+        peek();
+        const char *first = cur_;
+        bool negative = cur_ != last_ && *cur_ == '-';
+        cur_ += negative;
+        if (!is_digit()) {
+          fail("expected a number");
+        }  // if
+        if (*cur_ == '0' && cur_ + 1 != last_ && is_digit(cur_[1])) {
+          fail("leading zero");
+        }  // if
+        uint64_t magnitude = 0;
+        bool overflow = false;
+        for (; is_digit(); ++cur_) {
+          auto digit = static_cast<uint64_t>(*cur_ - '0');
+          overflow |= magnitude >
+                      (std::numeric_limits<uint64_t>::max() - digit) / 10;
+          magnitude = magnitude * 10 + digit;
+        }  // for
+        if (cur_ != last_ && (*cur_ == '.' || *cur_ == 'e' || *cur_ == 'E')) {
+          fail("expected an integer");
+        }  // if
+        using Limits = std::numeric_limits<Integral>;
+        uint64_t limit = static_cast<uint64_t>(Limits::max()) +
+                         (negative && std::is_signed<Integral>{});
+        if (std::is_unsigned<Integral>{} && negative) {
+          limit = 0;
+        }  // if
+        if (overflow || magnitude > limit) {
+          cur_ = first;
+          fail("number out of range");
+        }  // if
+        if (!negative) {
+          return static_cast<Integral>(magnitude);
+        }  // if
+        // `-(magnitude - 1) - 1`, to reach the minimum without overflowing.
+        return static_cast<Integral>(
+            -static_cast<int64_t>(magnitude - (magnitude != 0)) -
+            (magnitude != 0));
+      }
+
+      /* The digits are checked against the JSON grammar here and converted
+         by `atof`, correctly rounded whatever the locale. Values too large
+         for `Float` are out of range. */
+      template <typename Float>
+      Float read_float() {
+        static_assert(std::is_floating_point<Float>{}, "");
+        const char *first = scan_number();
+        Float result = atof::to_float<Float>(first, cur_);
+        if (result == std::numeric_limits<Float>::infinity() ||
+            result == -std::numeric_limits<Float>::infinity()) {
+          cur_ = first;
+          fail("number out of range");
+        }  // if
+        return result;
+      }
+
+      /* Checks a number as `read_float` would, converting it only when it
+         is near enough the limit of `Float` to be out of range. */
+      template <typename Float>
+      void check_float() {
+        static_assert(std::is_floating_point<Float>{}, "");
+        const char *first = scan_number();
+        if (atof::overflows<Float>(first, cur_)) {
+          cur_ = first;
+          fail("number out of range");
+        }  // if
+      }
+
+      std::size_t skipped() const { return skipped_; }
+
+      /* Passes over the value of a member whose key started at `from`,
+         counting the whole member as skipped. */
+      void skip_member(std::size_t from) {
+        skip_value();
+        skipped_ += offset() - from;
+      }
+
+      /* Passes over one value of any kind without decoding it, but checked
+         against the JSON grammar all the same: strings, numbers and
+         literals as the typed reads check them, and containers down to
+         their commas, colons and matching brackets. */
+      void skip_value() {
+        switch (peek()) {
+          case '{':
+          case '[':
+            skip_container();
+            return;
+          default:
+            skip_scalar();
+            return;
+        }  // switch
+      }
+
+      /* Unescapes a string into `out`. */
+      void read_string(std::string &out) {
+        const char *first = begin_string();
+        const char *last = escape::find(first, last_);
+        out.assign(first, last);
+        cur_ = last;
+        end_string(out);
+      }
+
+      /* A string borrowed from the input when it has no escapes (and
+         borrowing is on), and otherwise unescaped into the arena, failing
+         if there is none. */
+      std::pair<const char *, std::size_t> read_string_view() {
+        const char *first = begin_string();
+        const char *last = escape::find(first, last_);
+        bool escaped = last == last_ || *last != '"';
+        if (borrow_ && !escaped) {
+          cur_ = last + 1;
+          return {first, static_cast<std::size_t>(last - first)};
+        }  // if
+        std::string out(first, last);
+        cur_ = last;
+        end_string(out);
+        if (!arena_) {
+          cur_ = first - 1;
+          fail(escaped ? "escaped string needs a string_arena"
+                       : "string_view needs a string_arena");
+        }  // if
+        const std::string &kept = arena_->keep(std::move(out));
+        return {kept.data(), kept.size()};
+      }
+
+      /* An object key, borrowed from the input unless it has escapes, in
+         which case it is unescaped into a scratch buffer. Either way it is
+         valid until the next `read_key`. */
+      const char *read_key(std::size_t &size) {
+        const char *first = begin_string();
+        const char *last = escape::find(first, last_);
+        if (last != last_ && *last == '"') {
+          cur_ = last + 1;
+          size = static_cast<std::size_t>(last - first);
+          return first;
+        }  // if
+        key_.assign(first, last);
+        cur_ = last;
+        end_string(key_);
+        size = key_.size();
+        return key_.data();
+      }
+
+      /* Checks a string as `read_string` would, escapes and all, without
+         unescaping it anywhere. */
+      void check_string() {
+        begin_string();
+        cur_ = escape::find(cur_, last_);
+        discard out;
+        end_string(out);
+      }
+
+      private:
+      /* Takes unescaped characters and drops them. */
+      struct discard {
+        void operator+=(char) {}
+        void append(const char *, const char *) {}
+      };  // discard
+
+      /* The brackets open around the element being skipped, one bit each
+         with the innermost lowest. Only nesting deeper than 64 allocates. */
+      class brackets {
+        public:
+        std::size_t depth() const { return depth_; }
+
+        /* What closes the innermost bracket. */
+        char closer() const { return open_ & 1 ? '}' : ']'; }
+
+        void push(char c) {
+          if (depth_ != 0 && depth_ % 64 == 0) {
+            outer_.push_back(open_);
+            open_ = 0;
+          }  // if
+          open_ = open_ << 1 | (c == '{');
+          ++depth_;
+        }
+
+        void pop() {
+          open_ >>= 1;
+          if (--depth_ != 0 && depth_ % 64 == 0) {
+            open_ = outer_.back();
+            outer_.pop_back();
+          }  // if
+        }
+
+        private:
+        uint64_t open_ = 0;
+        std::size_t depth_ = 0;
+        std::vector<uint64_t> outer_;
+      };  // brackets
+
+      /* A string, number or literal. */
+      void skip_scalar() {
+        switch (peek()) {
+          case '"':
+            check_string();
+            return;
+          case 't':
+            consume_literal("true");
+            return;
+          case 'f':
+            consume_literal("false");
+            return;
+          case 'n':
+            consume_literal("null");
+            return;
+          case '-':
+          case '0': case '1': case '2': case '3': case '4':
+          case '5': case '6': case '7': case '8': case '9':
+            scan_number();
+            return;
+          default:
+            fail("expected a value");
+        }  // switch
+      }
+
+      /* An object or array, a level at a time rather than by recursion, so
+         that no nesting can exhaust the stack. */
+      void skip_container() {
+        brackets open;
+        for (;;) {
+          // A value: a container opens, and anything else is passed over.
+          char c = peek();
+          if (c == '{' || c == '[') {
+            ++cur_;
+            open.push(c);
+            if (!consume(open.closer())) {
+              begin_element(open);
+              continue;
+            }  // if
+            open.pop();
+          } else {
+            skip_scalar();
+          }  // if
+          // After a value, a comma starts the next element of the
+          // innermost container, and anything else must close it.
+          for (;;) {
+            if (open.depth() == 0) {
+              return;
+            }  // if
+            if (consume(',')) {
+              begin_element(open);
+              break;
+            }  // if
+            expect(open.closer());
+            open.pop();
+          }  // for
+        }  // for
+      }
+
+      /* In an object, the key and colon before the value. */
+      void begin_element(const brackets &open) {
+        if (open.closer() == '}') {
+          check_string();
+          expect(':');
+        }  // if
+      }
+
+      /* Passes over a number that matches the JSON grammar and returns
+         where it starts. */
+      const char *scan_number() {
+        peek();
+        const char *first = cur_;
+        cur_ += cur_ != last_ && *cur_ == '-';
+        if (!is_digit()) {
+          fail("expected a number");
+        }  // if
+        if (*cur_ == '0') {
+          ++cur_;
+        } else {
+          skip_digits();
+        }  // if
+        if (cur_ != last_ && *cur_ == '.') {
+          ++cur_;
+          if (!is_digit()) {
+            fail("expected a digit");
+          }  // if
+          skip_digits();
+        }  // if
+        if (cur_ != last_ && (*cur_ == 'e' || *cur_ == 'E')) {
+          ++cur_;
+          if (cur_ != last_ && (*cur_ == '+' || *cur_ == '-')) {
+            ++cur_;
+          }  // if
+          if (!is_digit()) {
+            fail("expected a digit");
+          }  // if
+          skip_digits();
+        }  // if
+        return first;
+      }
+
+      static bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+      bool is_digit() const { return cur_ != last_ && is_digit(*cur_); }
+
+      void skip_digits() {
+        while (is_digit()) {
+          ++cur_;
+        }  // while
+      }
+
+      const char *begin_string() {
+        if (!consume('"')) {
+          fail("expected a string");
+        }  // if
+        return cur_;
+      }
+
+      /* Appends the rest of a string from `cur_`, which `escape::find`
+         stopped at, up to and past the closing quote. */
+      template <typename Out>
+      void end_string(Out &out) {
+        for (;;) {
+          if (cur_ == last_) {
+            fail("unterminated string");
+          }  // if
+          char c = *cur_;
+          if (c == '"') {
+            ++cur_;
+            return;
+          }  // if
+          if (c != '\\') {
+            fail("control character in string");
+          }  // if
+          if (++cur_ == last_) {
+            fail("unterminated string");
+          }  // if
+          switch (*cur_++) {
+            case '"': out += '"'; break;
+            case '\\': out += '\\'; break;
+            case '/': out += '/'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': append_utf8(out, read_code_point()); break;
+            default:
+              --cur_;
+              fail("invalid escape");
+          }  // switch
+          const char *last = escape::find(cur_, last_);
+          out.append(cur_, last);
+          cur_ = last;
+        }  // for
+      }
+
+      /* The code point of a `\u` escape whose `\u` has been consumed,
+         combining a surrogate pair into one. */
+      uint32_t read_code_point() {
+        uint32_t result = read_hex4();
+        if (result >= 0xDC00 && result <= 0xDFFF) {
+          fail("unpaired surrogate");
+        }  // if
+        if (result >= 0xD800 && result <= 0xDBFF) {
+          if (last_ - cur_ < 2 || cur_[0] != '\\' || cur_[1] != 'u') {
+            fail("unpaired surrogate");
+          }  // if
+          cur_ += 2;
+          uint32_t low = read_hex4();
+          if (low < 0xDC00 || low > 0xDFFF) {
+            fail("unpaired surrogate");
+          }  // if
+          result = 0x10000 + ((result - 0xD800) << 10) + (low - 0xDC00);
+        }  // if
+        return result;
+      }
+
+      uint32_t read_hex4() {
+        if (last_ - cur_ < 4) {
+          fail("invalid escape");
+        }  // if
+        uint32_t result = 0;
+        for (int i = 0; i < 4; ++i, ++cur_) {
+          char c = *cur_;
+          uint32_t digit;
+          if (c >= '0' && c <= '9') {
+            digit = static_cast<uint32_t>(c - '0');
+          } else if (c >= 'a' && c <= 'f') {
+            digit = static_cast<uint32_t>(c - 'a' + 10);
+          } else if (c >= 'A' && c <= 'F') {
+            digit = static_cast<uint32_t>(c - 'A' + 10);
+          } else {
+            fail("invalid escape");
+          }  // if
+          result = result << 4 | digit;
+        }  // for
+        return result;
+      }
+
+      template <typename Out>
+      static void append_utf8(Out &out, uint32_t c) {
+        if (c < 0x80) {
+          out += static_cast<char>(c);
+        } else if (c < 0x800) {
+          out += static_cast<char>(0xC0 | c >> 6);
+          out += static_cast<char>(0x80 | (c & 0x3F));
+        } else if (c < 0x10000) {
+          out += static_cast<char>(0xE0 | c >> 12);
+          out += static_cast<char>(0x80 | (c >> 6 & 0x3F));
+          out += static_cast<char>(0x80 | (c & 0x3F));
+        } else {
+          out += static_cast<char>(0xF0 | c >> 18);
+          out += static_cast<char>(0x80 | (c >> 12 & 0x3F));
+          out += static_cast<char>(0x80 | (c >> 6 & 0x3F));
+          out += static_cast<char>(0x80 | (c & 0x3F));
+        }  // if
+      }
+
+      const char *first_;
+      const char *cur_;
+      const char *last_;
+      std::string key_;
+      std::size_t skipped_ = 0;
+      string_arena *arena_ = nullptr;
+      bool borrow_ = true;
+      std::size_t base_ = 0;
+      std::size_t line_ = 0;
+    };  // reader
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_READER_HPP
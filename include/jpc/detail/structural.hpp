@@ -0,0 +1,182 @@
+#ifndef DETAIL_STRUCTURAL_HPP
+#define DETAIL_STRUCTURAL_HPP
+
+#include <cstdint>
+
+#include <jpc/detail/escape.hpp>
+
+namespace jpc {
+
+  namespace detail {
+
+    namespace structural {
+
+      /* Structural classification, after simdjson's first stage.
+
+         64 bytes at a time, finds where every token starts: `{ } [ ] : ,`
+         outside strings, the opening quote of each string and the first
+         byte of every other scalar. The push parser uses it to find where
+         the members of its container end without looking at every byte.
+
+         Each kernel only classifies the 64 bytes into quote, backslash,
+         operator and whitespace bitmasks; what is inside a string is then
+         worked out on those masks by the same code for every kernel, so
+         their results are identical. */
+
+      struct masks {
+        uint64_t quote;
+        uint64_t backslash;
+        uint64_t op;
+        uint64_t ws;
+      };
+
+      inline bool is_op(unsigned char c) {
+        return c == '{' || c == '}' || c == '[' || c == ']' || c == ':' ||
+               c == ',';
+      }
+
+      inline bool is_ws(unsigned char c) {
+        return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+      }
+
+      inline masks classify_scalar(const char *block) {
+        masks result = {0, 0, 0, 0};
+        for (int i = 0; i < 64; ++i) {
+          auto c = static_cast<unsigned char>(block[i]);
+          uint64_t bit = uint64_t{1} << i;
+          result.quote |= c == '"' ? bit : 0;
+          result.backslash |= c == '\\' ? bit : 0;
+          result.op |= is_op(c) ? bit : 0;
+          result.ws |= is_ws(c) ? bit : 0;
+        }  // for
+        return result;
+      }
+
+#if JPC_X86
+      // The whitespace bytes all differ in their low nibble, so one
+      // `pshufb` on it and a compare find them. The other entries are
+      // 0x80: a byte with its high bit set looks up 0 instead, so no
+      // byte ever finds itself there.
+#define JPC_WS_TABLE                                                      \
+  ' ', -128, -128, -128, -128, -128, -128, -128, -128, '\t', '\n', -128, \
+      -128, '\r', -128, -128
+
+      __attribute__((target("sse4.2")))
+      inline masks classify_sse42(const char *block) {
+        const __m128i ws_table = _mm_setr_epi8(JPC_WS_TABLE);
+        masks result = {0, 0, 0, 0};
+        for (int i = 0; i < 4; ++i) {
+          __m128i v = _mm_loadu_si128(
+              reinterpret_cast<const __m128i *>(block + 16 * i));
+          __m128i op = _mm_or_si128(
+              _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('{')),
+                                        _mm_cmpeq_epi8(v, _mm_set1_epi8('}'))),
+                           _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('[')),
+                                        _mm_cmpeq_epi8(v, _mm_set1_epi8(']')))),
+              _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')),
+                           _mm_cmpeq_epi8(v, _mm_set1_epi8(','))));
+          __m128i ws = _mm_cmpeq_epi8(_mm_shuffle_epi8(ws_table, v), v);
+#define BITS(m) uint64_t{static_cast<uint16_t>(_mm_movemask_epi8(m))} << 16 * i
+          result.quote |= BITS(_mm_cmpeq_epi8(v, _mm_set1_epi8('"')));
+          result.backslash |= BITS(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\')));
+          result.op |= BITS(op);
+          result.ws |= BITS(ws);
+#undef BITS
+        }  // for
+        return result;
+      }
+
+      __attribute__((target("avx2")))
+      inline masks classify_avx2(const char *block) {
+        const __m256i ws_table = _mm256_setr_epi8(JPC_WS_TABLE, JPC_WS_TABLE);
+        masks result = {0, 0, 0, 0};
+        for (int i = 0; i < 2; ++i) {
+          __m256i v = _mm256_loadu_si256(
+              reinterpret_cast<const __m256i *>(block + 32 * i));
+          __m256i op = _mm256_or_si256(
+              _mm256_or_si256(
+                  _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('{')),
+                                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8('}'))),
+                  _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('[')),
+                                  _mm256_cmpeq_epi8(v, _mm256_set1_epi8(']')))),
+              _mm256_or_si256(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(':')),
+                              _mm256_cmpeq_epi8(v, _mm256_set1_epi8(','))));
+          __m256i ws = _mm256_cmpeq_epi8(_mm256_shuffle_epi8(ws_table, v), v);
+#define BITS(m) uint64_t{static_cast<uint32_t>(_mm256_movemask_epi8(m))} << 32 * i
+          result.quote |= BITS(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('"')));
+          result.backslash |= BITS(_mm256_cmpeq_epi8(v, _mm256_set1_epi8('\\')));
+          result.op |= BITS(op);
+          result.ws |= BITS(ws);
+#undef BITS
+        }  // for
+        return result;
+      }
+
+#undef JPC_WS_TABLE
+#endif
+
+      using classify_fn = masks (*)(const char *);
+
+      /* What one block leaves for the next. */
+      struct carry {
+        uint64_t escaped = 0;    // The next byte is escaped.
+        uint64_t in_string = 0;  // All ones inside a string.
+        uint64_t scalar = 0;     // The last byte was part of a scalar.
+      };
+
+      /* Bits of the bytes escaped by a backslash, odd runs of backslashes
+         included. */
+      inline uint64_t escaped(uint64_t backslash, carry &carry) {
+        const uint64_t even = 0x5555555555555555;
+        backslash &= ~carry.escaped;
+        uint64_t follows_escape = backslash << 1 | carry.escaped;
+        uint64_t odd_starts = backslash & ~even & ~follows_escape;
+        uint64_t even_starts;
+        carry.escaped = __builtin_add_overflow(odd_starts, backslash, &even_starts);
+        return (even ^ (even_starts << 1)) & follows_escape;
+      }
+
+      /* Each bit is the xor of itself and every bit below it. */
+      inline uint64_t prefix_xor(uint64_t x) {
+        x ^= x << 1;
+        x ^= x << 2;
+        x ^= x << 4;
+        x ^= x << 8;
+        x ^= x << 16;
+        x ^= x << 32;
+        return x;
+      }
+
+      /* The token starts in a block. */
+      inline uint64_t find(const masks &masks, carry &carry) {
+        uint64_t quote = masks.quote & ~escaped(masks.backslash, carry);
+        // Opening quotes and string contents, but not closing quotes.
+        uint64_t in_string = prefix_xor(quote) ^ carry.in_string;
+        carry.in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+        uint64_t scalar = ~(masks.op | masks.ws | quote) & ~in_string;
+        uint64_t scalar_start = scalar & ~(scalar << 1 | carry.scalar);
+        carry.scalar = scalar >> 63;
+        return (masks.op & ~in_string) | (quote & in_string) | scalar_start;
+      }
+
+      /* The fastest classifier this machine runs. */
+      inline classify_fn select_classify() {
+#if JPC_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) {
+          return classify_avx2;
+        }  // if
+        if (__builtin_cpu_supports("sse4.2")) {
+          return classify_sse42;
+        }  // if
+#endif
+        return classify_scalar;
+      }
+
+    }  // namespace structural
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_STRUCTURAL_HPP
@@ -0,0 +1,460 @@
+#ifndef DETAIL_WIRE_HPP
+#define DETAIL_WIRE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <jpc/detail/reader.hpp>
+
+namespace jpc {
+
+  namespace detail {
+
+    namespace wire {
+
+      /* The protobuf wire format, written straight from C++ values and
+         read straight back into them.
+
+         Every value is first turned into the 64 bits that go on the wire
+         (`bits`), then laid out as its field's encoding demands: a varint,
+         4 or 8 little-endian bytes, or a varint length followed by the
+         bytes themselves. Reading undoes the two steps in reverse
+         (`input`, then `from_bits`). */
+
+      enum class encoding : uint8_t {
+        varint,
+        zigzag,  // sint32, sint64
+        fixed32,
+        fixed64,
+        length_delimited
+      };
+
+      /* A field as laid out on the wire. `tag` is the key written before
+         each value, or before the one length of a packed repeated field. */
+      struct field {
+        uint32_t tag;
+        wire::encoding encoding;
+        bool packed;
+      };
+
+      inline uint32_t wire_type(encoding encoding) {
+        switch (encoding) {
+          case encoding::varint:
+          case encoding::zigzag:
+            return 0;
+          case encoding::fixed64:
+            return 1;
+          case encoding::length_delimited:
+            return 2;
+          case encoding::fixed32:
+            return 5;
+        }  // switch
+        return 0;
+      }
+
+      inline field make_field(uint32_t number, encoding encoding, bool packed) {
+        return {number << 3 | (packed ? 2 : wire_type(encoding)), encoding, packed};
+      }
+
+      /* bits */
+
+      inline uint64_t bits(encoding, bool value) { return value; }
+      inline uint64_t bits(encoding, uint32_t value) { return value; }
+      inline uint64_t bits(encoding, uint64_t value) { return value; }
+
+      /* Negative numbers are sign-extended, as protobuf does for int32;
+         zigzag maps them to small ones instead. */
+      inline uint64_t bits(encoding encoding, int64_t value) {
+        return encoding == encoding::zigzag
+                   ? static_cast<uint64_t>(value) << 1 ^
+                         static_cast<uint64_t>(value >> 63)
+                   : static_cast<uint64_t>(value);
+      }
+
+      inline uint64_t bits(encoding encoding, int32_t value) {
+        return bits(encoding, int64_t{value});
+      }
+
+      inline uint64_t bits(encoding, float value) {
+        uint32_t result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+      }
+
+      inline uint64_t bits(encoding, double value) {
+        uint64_t result;
+        std::memcpy(&result, &value, sizeof(result));
+        return result;
+      }
+
+      /* from_bits */
+
+      inline void from_bits(encoding, uint64_t bits, bool &value) { value = bits != 0; }
+
+      inline void from_bits(encoding, uint64_t bits, uint32_t &value) {
+        value = static_cast<uint32_t>(bits);
+      }
+
+      inline void from_bits(encoding, uint64_t bits, uint64_t &value) { value = bits; }
+
+      inline void from_bits(encoding encoding, uint64_t bits, int64_t &value) {
+        value = encoding == encoding::zigzag
+                    ? static_cast<int64_t>(bits >> 1) ^ -static_cast<int64_t>(bits & 1)
+                    : static_cast<int64_t>(bits);
+      }
+
+      /* Truncated, as protobuf does. */
+      inline void from_bits(encoding encoding, uint64_t bits, int32_t &value) {
+        int64_t result;
+        from_bits(encoding, bits, result);
+        value = static_cast<int32_t>(result);
+      }
+
+      inline void from_bits(encoding, uint64_t bits, float &value) {
+        auto result = static_cast<uint32_t>(bits);
+        std::memcpy(&value, &result, sizeof(value));
+      }
+
+      inline void from_bits(encoding, uint64_t bits, double &value) {
+        std::memcpy(&value, &bits, sizeof(value));
+      }
+
+      /* sizes */
+
+      /* One byte per 7 bits, without a loop. */
+      inline std::size_t varint_size(uint64_t value) {
+        return static_cast<std::size_t>(((63 - __builtin_clzll(value | 1)) * 9 + 73) / 64);
+      }
+
+      inline std::size_t value_size(encoding encoding, uint64_t bits) {
+        switch (encoding) {
+          case encoding::fixed32:
+            return 4;
+          case encoding::fixed64:
+            return 8;
+          default:
+            return varint_size(bits);
+        }  // switch
+      }
+
+      /* A tagged scalar. */
+      inline std::size_t scalar_size(const field &field, uint64_t bits) {
+        return varint_size(field.tag) + value_size(field.encoding, bits);
+      }
+
+      /* A tag and a length followed by `size` bytes. */
+      inline std::size_t length_delimited_size(const field &field, std::size_t size) {
+        return varint_size(field.tag) + varint_size(size) + size;
+      }
+
+      /* writes, into room for the longest form */
+
+      static constexpr std::size_t max_varint_size = 10;
+
+      inline char *write_varint(char *p, uint64_t value) {
+        for (; value >= 0x80; value >>= 7) {
+          *p++ = static_cast<char>(value | 0x80);
+        }  // for
+        *p++ = static_cast<char>(value);
+        return p;
+      }
+
+      inline char *write_fixed(char *p, uint64_t value, std::size_t size) {
+        for (std::size_t i = 0; i < size; ++i) {
+          p[i] = static_cast<char>(value >> 8 * i);
+        }  // for
+        return p + size;
+      }
+
+      inline char *write_value(char *p, encoding encoding, uint64_t bits) {
+        switch (encoding) {
+          case encoding::fixed32:
+            return write_fixed(p, bits, 4);
+          case encoding::fixed64:
+            return write_fixed(p, bits, 8);
+          default:
+            return write_varint(p, bits);
+        }  // switch
+      }
+
+      template <typename Writer>
+      void write_value(Writer &writer, encoding encoding, uint64_t bits) {
+        writer.commit(write_value(writer.prepare(max_varint_size), encoding, bits));
+      }
+
+      template <typename Writer>
+      void write_scalar(Writer &writer, const field &field, uint64_t bits) {
+        char *p = writer.prepare(2 * max_varint_size);
+        writer.commit(write_value(write_varint(p, field.tag), field.encoding, bits));
+      }
+
+      /* The tag and length; the caller writes the `size` bytes. */
+      template <typename Writer>
+      void write_length(Writer &writer, const field &field, std::size_t size) {
+        char *p = writer.prepare(2 * max_varint_size);
+        writer.commit(write_varint(write_varint(p, field.tag), size));
+      }
+
+      /* sizes: the sizes of nested messages, noted in the order they are
+         written. A message's length comes before its fields, so without
+         these each would be sized again at every level it is nested in.
+         Sizing a message notes those under it; writing one takes its own
+         size back out, or sizes it there if it was never noted. */
+
+      class sizes {
+        public:
+        sizes() = default;
+
+        sizes(const sizes &) = delete;
+        sizes &operator=(const sizes &) = delete;
+
+        /* Whether every size noted has been taken back out. */
+        bool empty() const { return next_ == size_; }
+
+        /* Makes room for the size of the next message, to `set` once its
+           own nested messages have theirs. */
+        std::size_t reserve() {
+          if (empty()) {
+            size_ = next_ = 0;
+            outer_.clear();
+          }  // if
+          if (size_ >= inline_size) {
+            outer_.push_back(0);
+          }  // if
+          return size_++;
+        }
+
+        void set(std::size_t i, std::size_t size) { at(i) = size; }
+
+        /* The size of the next message to be written. */
+        std::size_t next() { return at(next_++); }
+
+        private:
+        static constexpr std::size_t inline_size = 16;
+
+        std::size_t &at(std::size_t i) {
+          return i < inline_size ? inline_[i] : outer_[i - inline_size];
+        }
+
+        std::size_t inline_[inline_size];
+        std::vector<std::size_t> outer_;
+        std::size_t size_ = 0;
+        std::size_t next_ = 0;
+      };  // sizes
+
+      /* input: a cursor over wire bytes for the schema-driven decoders.
+
+         A nested message is read between `push_limit` and `pop_limit`, as
+         with `CodedInputStream`, so that `done` is its end. Errors are
+         `parse_error`s with offsets into the whole input. */
+
+      class input {
+        public:
+        input(const char *first, const char *last)
+            : first_(first), cur_(first), last_(last) {}
+
+        input(const input &) = delete;
+        input &operator=(const input &) = delete;
+
+        bool done() const { return cur_ == last_; }
+
+        std::size_t offset() const { return static_cast<std::size_t>(cur_ - first_); }
+
+        /* Bytes of fields the schema does not declare, tags included. */
+        std::size_t skipped() const { return skipped_; }
+
+        [[noreturn]] void fail(const std::string &what) const {
+          throw parse_error(what, offset());
+        }
+
+        uint64_t read_varint() {
+          if (cur_ != last_ && static_cast<unsigned char>(*cur_) < 0x80) {
+            return static_cast<unsigned char>(*cur_++);
+          }  // if
+          return read_varint_slow();
+        }
+
+        /* The number of the next field; its wire type goes to `wire_type`. */
+        uint32_t read_tag(uint32_t &wire_type) {
+          tag_ = cur_;
+          uint64_t tag = read_varint();
+          if (tag >> 32 || tag >> 3 == 0) {
+            fail("invalid tag");
+          }  // if
+          wire_type = static_cast<uint32_t>(tag & 7);
+          return static_cast<uint32_t>(tag >> 3);
+        }
+
+        /* A scalar, which must have come with `encoding`'s wire type. */
+        uint64_t read_value(encoding encoding, uint32_t wire_type) {
+          if (wire_type != wire::wire_type(encoding)) {
+            fail("unexpected wire type");
+          }  // if
+          switch (encoding) {
+            case encoding::fixed32:
+              return read_fixed<4>();
+            case encoding::fixed64:
+              return read_fixed<8>();
+            default:
+              return read_varint();
+          }  // switch
+        }
+
+        /* The length of a length-delimited value, whose bytes come next. */
+        std::size_t read_length(uint32_t wire_type) {
+          if (wire_type != 2) {
+            fail("unexpected wire type");
+          }  // if
+          uint64_t size = read_varint();
+          if (size > static_cast<uint64_t>(last_ - cur_)) {
+            fail("truncated message");
+          }  // if
+          return static_cast<std::size_t>(size);
+        }
+
+        std::pair<const char *, std::size_t> read_bytes(uint32_t wire_type) {
+          std::size_t size = read_length(wire_type);
+          const char *first = cur_;
+          cur_ += size;
+          return {first, size};
+        }
+
+        /* Ends the input `size` bytes on, returning the end to restore. */
+        const char *push_limit(std::size_t size) {
+          const char *last = last_;
+          last_ = cur_ + size;
+          return last;
+        }
+
+        void pop_limit(const char *last) { last_ = last; }
+
+        /* Passes over the value of the field whose tag was just read,
+           counting the whole field as skipped. */
+        void skip(uint32_t wire_type) {
+          switch (wire_type) {
+            case 0:
+              read_varint();
+              break;
+            case 1:
+              read_fixed<8>();
+              break;
+            case 2:
+              read_bytes(wire_type);
+              break;
+            case 5:
+              read_fixed<4>();
+              break;
+            default:
+              fail("unsupported wire type");
+          }  // switch
+          skipped_ += static_cast<std::size_t>(cur_ - tag_);
+        }
+
+        private:
+        /* Tags and most values are a single byte; longer varints take a
+           call. */
+        uint64_t read_varint_slow() {
+          uint64_t result = 0;
+          if (last_ - cur_ >= static_cast<std::ptrdiff_t>(max_varint_size)) {
+            // No bounds to check.
+            for (int shift = 0; shift < 64; shift += 7) {
+              auto byte = static_cast<unsigned char>(*cur_++);
+              result |= uint64_t{byte & 0x7fu} << shift;
+              if (byte < 0x80) {
+                return result;
+              }  // if
+            }  // for
+            fail("malformed varint");
+          }  // if
+          for (int shift = 0; shift < 64; shift += 7) {
+            if (cur_ == last_) {
+              fail("truncated message");
+            }  // if
+            auto byte = static_cast<unsigned char>(*cur_++);
+            result |= uint64_t{byte & 0x7fu} << shift;
+            if (byte < 0x80) {
+              return result;
+            }  // if
+          }  // for
+          fail("malformed varint");
+        }
+
+        template <std::size_t Size>
+        uint64_t read_fixed() {
+          if (static_cast<std::size_t>(last_ - cur_) < Size) {
+            fail("truncated message");
+          }  // if
+          uint64_t result = 0;
+          for (std::size_t i = 0; i < Size; ++i) {
+            result |= uint64_t{static_cast<unsigned char>(cur_[i])} << 8 * i;
+          }  // for
+          cur_ += Size;
+          return result;
+        }
+
+        const char *first_;
+        const char *cur_;
+        const char *last_;
+        const char *tag_ = nullptr;
+        std::size_t skipped_ = 0;
+      };  // input
+
+      /* field_table: the index of the field with a given number, straight
+         out of an array for the small numbers fields mostly have and by
+         binary search for the rest. */
+
+      class field_table {
+        public:
+        static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+        /* Field `i` has number `numbers[i]`, or none if it is 0. */
+        explicit field_table(const std::vector<uint32_t> &numbers) {
+          const std::size_t none = npos;
+          for (std::size_t i = 0; i < numbers.size(); ++i) {
+            const uint32_t number = numbers[i];
+            if (number == 0) {
+              continue;
+            }  // if
+            if (number < dense_limit) {
+              if (dense_.size() <= number) {
+                dense_.resize(number + 1, none);
+              }  // if
+              dense_[number] = i;
+            } else {
+              sparse_.emplace_back(number, i);
+            }  // if
+          }  // for
+          std::sort(sparse_.begin(), sparse_.end());
+        }
+
+        std::size_t find(uint32_t number) const {
+          if (number < dense_.size()) {
+            return dense_[number];
+          }  // if
+          auto iter = std::lower_bound(
+              sparse_.begin(), sparse_.end(), std::make_pair(number, std::size_t{0}));
+          if (iter == sparse_.end() || iter->first != number) {
+            return npos;
+          }  // if
+          return iter->second;
+        }
+
+        private:
+        static constexpr uint32_t dense_limit = 256;
+
+        std::vector<std::size_t> dense_;
+        std::vector<std::pair<uint32_t, std::size_t>> sparse_;
+      };  // field_table
+
+    }  // namespace wire
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_WIRE_HPP
@@ -0,0 +1,402 @@
+#ifndef DETAIL_WRITER_HPP
+#define DETAIL_WRITER_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <climits>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <cerrno>
+#define JPC_POSIX 1
+#else
+#define JPC_POSIX 0
+#endif
+
+namespace jpc {
+
+  namespace detail {
+
+    /* writers.
+
+       A `Writer` is a contiguous window of `char`s that the JSON serializers
+       append into directly. The fast paths (`put`, `write`, `prepare`) are
+       inline pointer bumps; only running out of room calls into
+       `Derived::overflow(n)`, which must make at least `min(n, capacity)`
+       (and at least one) bytes available between `cur_` and `end_`.
+
+       `prepare(n)` hands out `n` writable bytes (`n` must be small, e.g. the
+       longest number) and `commit(last)` marks `[prepare(n), last)` as
+       written. */
+
+    template <typename Derived>
+    class basic_writer {
+      public:
+      void put(char c) {
+        if (cur_ == end_) {
+          derived().overflow(1);
+        }  // if
+        *cur_++ = c;
+      }
+
+      void write(const char *s, std::size_t n) {
+        if (n <= available()) {
+          std::memcpy(cur_, s, n);
+          cur_ += n;
+          return;
+        }  // if
+        write_slow(s, n);
+      }
+
+      template <std::size_t N>
+      void write(const char (&s)[N]) {
+        write(s, N - 1);
+      }
+
+      char *prepare(std::size_t n) {
+        if (available() < n) {
+          derived().overflow(n);
+        }  // if
+        return cur_;
+      }
+
+      void commit(char *last) { cur_ = last; }
+
+      /* Writes each of `buffers` (anything with `data()` and `size()`) in
+         turn. */
+      template <typename Buffers>
+      void write_all(const Buffers &buffers) {
+        for (const auto &buffer : buffers) {
+          derived().write(buffer.data(), buffer.size());
+        }  // for
+      }
+
+      protected:
+      basic_writer() = default;
+      basic_writer(const basic_writer &) = default;
+      basic_writer &operator=(const basic_writer &) = default;
+
+      std::size_t available() const {
+        return static_cast<std::size_t>(end_ - cur_);
+      }
+
+      char *cur_ = nullptr;
+      char *end_ = nullptr;
+
+      private:
+      Derived &derived() { return static_cast<Derived &>(*this); }
+
+      void write_slow(const char *s, std::size_t n) {
+        derived().overflow(n);
+        while (available() < n) {
+          std::size_t size = available();
+          std::memcpy(cur_, s, size);
+          cur_ += size;
+          s += size;
+          n -= size;
+          derived().overflow(n);
+        }  // while
+        std::memcpy(cur_, s, n);
+        cur_ += n;
+      }
+    };  // basic_writer
+
+    /* buffer: a growable, owning `char` buffer. */
+
+    class buffer : public basic_writer<buffer> {
+      public:
+      buffer() = default;
+
+      explicit buffer(std::size_t capacity) { reserve(capacity); }
+
+      buffer(buffer &&that) noexcept { swap(that); }
+
+      buffer &operator=(buffer &&that) noexcept {
+        swap(that);
+        return *this;
+      }
+
+      const char *data() const { return data_.get(); }
+      std::size_t size() const { return static_cast<std::size_t>(cur_ - data_.get()); }
+      std::size_t capacity() const { return static_cast<std::size_t>(end_ - data_.get()); }
+      bool empty() const { return cur_ == data_.get(); }
+
+      std::string str() const { return {data(), size()}; }
+
+      void clear() { cur_ = data_.get(); }
+
+      void reserve(std::size_t capacity) {
+        if (capacity <= this->capacity()) {
+          return;
+        }  // if
+        std::size_t size = this->size();
+        std::unique_ptr<char[]> data(new char[capacity]);
+        if (size) {
+          std::memcpy(data.get(), data_.get(), size);
+        }  // if
+        data_ = std::move(data);
+        cur_ = data_.get() + size;
+        end_ = data_.get() + capacity;
+      }
+
+      void swap(buffer &that) noexcept {
+        std::swap(data_, that.data_);
+        std::swap(cur_, that.cur_);
+        std::swap(end_, that.end_);
+      }
+
+      private:
+      void overflow(std::size_t n) {
+        reserve(std::max({size() + n, 2 * capacity(), std::size_t{256}}));
+      }
+
+      std::unique_ptr<char[]> data_;
+
+      friend class basic_writer<buffer>;
+    };  // buffer
+
+    /* string_writer: appends to a `std::string`.
+
+       The string is grown geometrically while writing and trimmed back to the
+       written length by `flush()` (or on destruction). */
+
+    class string_writer : public basic_writer<string_writer> {
+      public:
+      explicit string_writer(std::string &str) : str_(str) {
+        reset(str_.size());
+      }
+
+      string_writer(const string_writer &) = delete;
+      string_writer &operator=(const string_writer &) = delete;
+
+      ~string_writer() { flush(); }
+
+      void flush() {
+        std::size_t size = static_cast<std::size_t>(cur_ - &str_[0]);
+        str_.resize(size);
+        reset(size);
+      }
+
+      private:
+      void overflow(std::size_t n) {
+        std::size_t size = static_cast<std::size_t>(cur_ - &str_[0]);
+        str_.resize(std::max({size + n, 2 * str_.size(), std::size_t{256}}));
+        reset(size);
+      }
+
+      void reset(std::size_t size) {
+        cur_ = &str_[0] + size;
+        end_ = &str_[0] + str_.size();
+      }
+
+      std::string &str_;
+
+      friend class basic_writer<string_writer>;
+    };  // string_writer
+
+    /* sink_writer: buffers into a fixed-size block and hands each full block
+       to `sink(const char *, std::size_t)`. The tail is handed over by
+       `flush()` (or on destruction). */
+
+    template <typename Sink, std::size_t Size = 4096>
+    class sink_writer : public basic_writer<sink_writer<Sink, Size>> {
+      public:
+      static_assert(Size >= 64, "");
+
+      explicit sink_writer(Sink sink) : sink_(std::move(sink)) {
+        this->cur_ = block_.data();
+        this->end_ = block_.data() + Size;
+      }
+
+      sink_writer(const sink_writer &) = delete;
+      sink_writer &operator=(const sink_writer &) = delete;
+
+      ~sink_writer() { flush(); }
+
+      void flush() {
+        if (this->cur_ != block_.data()) {
+          sink_(static_cast<const char *>(block_.data()),
+                static_cast<std::size_t>(this->cur_ - block_.data()));
+          this->cur_ = block_.data();
+        }  // if
+      }
+
+      private:
+      void overflow(std::size_t) { flush(); }
+
+      Sink sink_;
+      std::array<char, Size> block_;
+
+      friend class basic_writer<sink_writer>;
+    };  // sink_writer
+
+    /* span_writer: writes into a caller-owned `[first, last)`, e.g. a slot
+       sized with `json_size`. Running out of room throws.
+
+       `prepare(n)` near the end hands out a scratch block instead, since a
+       number may well fit even when its longest form would not; `commit`
+       copies it in. */
+
+    class span_writer : public basic_writer<span_writer> {
+      public:
+      span_writer(char *first, char *last) : first_(first) {
+        cur_ = first;
+        end_ = last;
+      }
+
+      span_writer(char *first, std::size_t size)
+          : span_writer(first, first + size) {}
+
+      span_writer(const span_writer &) = delete;
+      span_writer &operator=(const span_writer &) = delete;
+
+      const char *data() const { return first_; }
+      std::size_t size() const { return static_cast<std::size_t>(cur_ - first_); }
+
+      char *prepare(std::size_t n) {
+        scratch_ = available() < n;
+        return scratch_ ? block_ : cur_;
+      }
+
+      void commit(char *last) {
+        if (scratch_) {
+          scratch_ = false;
+          write(block_, static_cast<std::size_t>(last - block_));
+        } else {
+          cur_ = last;
+        }  // if
+      }
+
+      private:
+      [[noreturn]] void overflow(std::size_t) {
+        throw std::runtime_error("out of space");
+      }
+
+      char *first_;
+      bool scratch_ = false;
+      char block_[32];
+
+      friend class basic_writer<span_writer>;
+    };  // span_writer
+
+#if JPC_POSIX
+    /* fd_writer: streams to a file descriptor through one fixed-size chunk,
+       so peak memory is the chunk no matter how large the output.
+
+       A `write` that does not fit in what is left of the chunk goes out in
+       the same `writev` as the chunk, straight from the caller's memory, so
+       long strings are never copied through the chunk piecemeal. Call
+       `flush()` to see errors from the last write; the destructor cannot
+       report them. */
+
+    class fd_writer : public basic_writer<fd_writer> {
+      public:
+      explicit fd_writer(int fd, std::size_t chunk_size = 64 * 1024)
+          : fd_(fd), chunk_(new char[std::max(chunk_size, std::size_t{64})]) {
+        cur_ = chunk_.get();
+        end_ = chunk_.get() + std::max(chunk_size, std::size_t{64});
+      }
+
+      fd_writer(const fd_writer &) = delete;
+      fd_writer &operator=(const fd_writer &) = delete;
+
+      ~fd_writer() {
+        try {
+          flush();
+        } catch (const std::system_error &) {
+        }  // try
+      }
+
+      using basic_writer::write;
+
+      void write(const char *s, std::size_t n) {
+        if (n <= available()) {
+          std::memcpy(cur_, s, n);
+          cur_ += n;
+          return;
+        }  // if
+        writev(s, n);
+      }
+
+      /* The pending chunk and all of `buffers` go out together, straight
+         from the buffers: one `writev` for every `IOV_MAX` of them. */
+      template <typename Buffers>
+      void write_all(const Buffers &buffers) {
+        std::vector<iovec> iov(1, pending());
+        for (const auto &buffer : buffers) {
+          iov.push_back({const_cast<char *>(buffer.data()), buffer.size()});
+        }  // for
+        gather(iov.data(), iov.size());
+      }
+
+      void flush() { writev(nullptr, 0); }
+
+      private:
+      void overflow(std::size_t) { flush(); }
+
+      iovec pending() const {
+        return {chunk_.get(), static_cast<std::size_t>(cur_ - chunk_.get())};
+      }
+
+      /* Writes the pending chunk followed by `[s, s + n)`. */
+      void writev(const char *s, std::size_t n) {
+        iovec iov[2] = {pending(), {const_cast<char *>(s), n}};
+        gather(iov, n ? 2 : 1);
+      }
+
+      /* Writes `[first, first + count)`, a few at a time if need be. */
+      void gather(iovec *first, std::size_t count) {
+#ifdef IOV_MAX
+        const std::size_t max_count = IOV_MAX;
+#else
+        const std::size_t max_count = 16;
+#endif
+        while (count > 0) {
+          if (first->iov_len == 0) {
+            ++first;
+            --count;
+            continue;
+          }  // if
+          ssize_t written =
+              ::writev(fd_, first, static_cast<int>(std::min(count, max_count)));
+          if (written < 0) {
+            if (errno == EINTR) {
+              continue;
+            }  // if
+            throw std::system_error(errno, std::generic_category(), "writev");
+          }  // if
+          auto rest = static_cast<std::size_t>(written);
+          while (count > 0 && rest >= first->iov_len) {
+            rest -= first->iov_len;
+            ++first;
+            --count;
+          }  // while
+          if (count > 0) {
+            first->iov_base = static_cast<char *>(first->iov_base) + rest;
+            first->iov_len -= rest;
+          }  // if
+        }  // while
+        cur_ = chunk_.get();
+      }
+
+      int fd_;
+      std::unique_ptr<char[]> chunk_;
+
+      friend class basic_writer<fd_writer>;
+    };  // fd_writer
+#endif
+
+  }  // namespace detail
+
+}  // namespace jpc
+
+#endif  // DETAIL_WRITER_HPP
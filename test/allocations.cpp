@@ -0,0 +1,58 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <jpc.hpp>
+
+#include "intro.hpp"
+#include "intro.pb.h"
+
+#include <gtest/gtest.h>
+
+using namespace intro;
+
+namespace {
+
+  std::size_t allocations = 0;
+
+  /* The heap allocations `f` makes. */
+  template <typename F>
+  std::size_t count_allocations(F f) {
+    const std::size_t before = allocations;
+    f();
+    return allocations - before;
+  }
+
+}  // namespace
+
+void *operator new(std::size_t size) {
+  ++allocations;
+  if (void *p = std::malloc(size ? size : 1)) {
+    return p;
+  }  // if
+  throw std::bad_alloc();
+}
+
+// Out of line, or the compiler sees `free` on what `new` returned.
+__attribute__((noinline)) void operator delete(void *p) noexcept { std::free(p); }
+__attribute__((noinline)) void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+/* A conversion allocates what the message ends up owning and nothing
+   more: nested messages and repeated fields are moved into place rather
+   than copied. */
+TEST(Allocations, Protobuf) {
+  const Foo foo = full_foo();
+  // The schemas and protobuf's descriptors are built on first use.
+  const FooInfo expected = Foo::full().protobuf(foo);
+  Foo::generated();
+  const std::size_t owned = count_allocations([&] { FooInfo copy(expected); });
+  EXPECT_EQ(owned, count_allocations([&] { FooInfo info = Foo::full().protobuf(foo); }));
+  EXPECT_EQ(owned, count_allocations([&] { FooInfo info = Foo::generated().protobuf(foo); }));
+}
@@ -0,0 +1,447 @@
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/optional/optional_io.hpp>
+#include <boost/utility/string_view.hpp>
+
+#include <jpc.hpp>
+
+#include <google/protobuf/dynamic_message.h>
+#include <google/protobuf/message.h>
+
+#include "intro.hpp"
+#include "intro.pb.h"
+
+#include <gtest/gtest.h>
+
+using namespace intro;
+
+namespace {
+
+  struct Numbers {
+    int32_t i32;
+    int64_t i64;
+    uint32_t u32;
+    uint64_t u64;
+    double f64;
+    float f32;
+  };
+
+  const auto &numbers() {
+    static const auto schema =
+        jpc::object<Numbers, google::protobuf::Message>(
+            jpc::field(jpc::number, &Numbers::i32, "i32"),
+            jpc::field(jpc::number, &Numbers::i64, "i64"),
+            jpc::field(jpc::number, &Numbers::u32, "u32"),
+            jpc::field(jpc::number, &Numbers::u64, "u64"),
+            jpc::field(jpc::number, &Numbers::f64, "f64"),
+            jpc::field(jpc::number, &Numbers::f32, "f32"));
+    return schema;
+  }
+
+  struct Names {
+    boost::string_view first;
+    boost::string_view last;
+  };
+
+  const auto &names() {
+    static const auto schema =
+        jpc::object<Names, google::protobuf::Message>(
+            jpc::field(jpc::string_view, &Names::first, "first"),
+            jpc::field(jpc::string_view, &Names::last, "last"));
+    return schema;
+  }
+
+  /* `numbers()` JSON with `value` in place of `key`'s 0. */
+  std::string numbers_with(const std::string &key, const std::string &value) {
+    std::string result =
+        R"({"i32":0,"i64":0,"u32":0,"u64":0,"f64":0,"f32":0})";
+    std::string needle = '"' + key + "\":0";
+    result.replace(result.find(needle), needle.size(),
+                   '"' + key + "\":" + value);
+    return result;
+  }
+
+  /* The offset of the `parse_error` thrown for `text`, or -1. */
+  template <typename Schema, typename Object>
+  long error_offset(const Schema &schema, const std::string &text, Object &value) {
+    try {
+      schema.from_json(text, value);
+    } catch (const jpc::parse_error &error) {
+      return static_cast<long>(error.offset());
+    }  // try
+    return -1;
+  }
+
+}  // namespace
+
+TEST(FromJson, Bar) {
+  Bar bar{false, 0, boost::none};
+  Bar::full().from_json(R"({"x":true,"y":-42,"z":"hi"})", bar);
+  EXPECT_TRUE(bar.x_);
+  EXPECT_EQ(-42, bar.y_);
+  EXPECT_EQ(boost::make_optional(std::string("hi")), bar.z_);
+
+  // Any key order and whitespace; `null` and absence both reset `z`.
+  Bar::full().from_json(" {\n\t\"z\" : null , \"y\":7,\"x\":false }\r\n", bar);
+  EXPECT_FALSE(bar.x_);
+  EXPECT_EQ(7, bar.y_);
+  EXPECT_EQ(boost::none, bar.z_);
+  bar.z_ = std::string("stale");
+  Bar::full().from_json(R"({"x":true,"y":1})", bar);
+  EXPECT_EQ(boost::none, bar.z_);
+}
+
+TEST(FromJson, RoundTrip) {
+  const std::string text = jpc::to_string(Foo::full().json(full_foo()));
+  Foo copy = sparse_foo();
+  Foo::assignable().from_json(text, copy);
+  EXPECT_EQ(text, jpc::to_string(Foo::full().json(copy)));
+}
+
+TEST(FromJson, JsonToProtobuf) {
+  const Foo foo = full_foo();
+  const std::string text = jpc::to_string(Foo::full().json(foo));
+  const FooInfo expected = Foo::full().protobuf(foo);
+  // Through reflection and through the generated accessors alike.
+  for (const FooInfo &actual :
+       {Foo::full().json_to_protobuf(text), Foo::generated().json_to_protobuf(text)}) {
+    EXPECT_EQ(expected.SerializeAsString(), actual.SerializeAsString());
+    EXPECT_FALSE(actual.has_m());
+    EXPECT_FALSE(actual.has_p());
+  }  // for
+
+  BarInfo bar = Bar::full().json_to_protobuf(R"({"y":7,"unknown":[1],"x":true})");
+  EXPECT_TRUE(bar.x());
+  EXPECT_EQ(7, bar.y());
+  EXPECT_FALSE(bar.has_z());
+
+  // A message of another type than `BarInfo`, but with its descriptor,
+  // is set through reflection even where the schema names accessors.
+  google::protobuf::DynamicMessageFactory factory;
+  const std::string bar_text = R"({"x":true,"y":7,"z":"z"})";
+  auto read_dynamic = [&](const auto &schema) {
+    std::unique_ptr<google::protobuf::Message> dynamic(
+        factory.GetPrototype(BarInfo::descriptor())->New());
+    jpc::detail::reader reader(bar_text.data(), bar_text.data() + bar_text.size());
+    schema.read_protobuf(reader, *dynamic);
+    return dynamic->SerializeAsString();
+  };
+  const std::string bar_bytes = Bar::full().json_to_protobuf(bar_text).SerializeAsString();
+  EXPECT_EQ(bar_bytes, Bar::generated().json_to_protobuf(bar_text).SerializeAsString());
+  EXPECT_EQ(bar_bytes, read_dynamic(Bar::full()));
+  EXPECT_EQ(bar_bytes, read_dynamic(Bar::generated()));
+
+  EXPECT_THROW(Bar::full().json_to_protobuf(R"({"x":true})"), jpc::parse_error);
+  EXPECT_THROW(Bar::full().json_to_protobuf(R"({"x":1,"y":1})"), jpc::parse_error);
+  EXPECT_THROW(Bar::full().json_to_protobuf(R"({"x":true,"y":1} 1)"),
+               jpc::parse_error);
+}
+
+TEST(FromJson, Strings) {
+  std::string value;
+  auto read = [&](const std::string &text) {
+    jpc::detail::reader reader(text.data(), text.data() + text.size());
+    jpc::string.read_json(reader, value);
+    reader.finish();
+    return value;
+  };
+  EXPECT_EQ("", read(R"("")"));
+  EXPECT_EQ("plain", read(R"("plain")"));
+  EXPECT_EQ("\"\\/\b\f\n\r\t", read(R"("\"\\\/\b\f\n\r\t")"));
+  EXPECT_EQ("caf\xc3\xa9", read(R"("café")"));
+  EXPECT_EQ("\xe2\x82\xac", read(R"("€")"));
+  EXPECT_EQ("\xf0\x9f\x98\x80", read(R"("😀")"));
+  EXPECT_EQ(std::string("a\0b", 3), read(R"("a\u0000b")"));
+  EXPECT_THROW(read(R"("\ud83d")"), jpc::parse_error);
+  EXPECT_THROW(read(R"("\ude00")"), jpc::parse_error);
+  EXPECT_THROW(read(R"("\x")"), jpc::parse_error);
+  EXPECT_THROW(read("\"a\nb\""), jpc::parse_error);
+  EXPECT_THROW(read(R"("open)"), jpc::parse_error);
+}
+
+TEST(FromJson, Numbers) {
+  Numbers value{};
+  numbers().from_json(
+      R"({"i32":-2147483648,"i64":-9223372036854775808,"u32":4294967295,)"
+      R"("u64":18446744073709551615,"f64":-1.5e-3,"f32":0.1})",
+      value);
+  EXPECT_EQ(std::numeric_limits<int32_t>::min(), value.i32);
+  EXPECT_EQ(std::numeric_limits<int64_t>::min(), value.i64);
+  EXPECT_EQ(std::numeric_limits<uint32_t>::max(), value.u32);
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(), value.u64);
+  EXPECT_EQ(-1.5e-3, value.f64);
+  EXPECT_EQ(0.1f, value.f32);
+
+  for (const auto &bad : {std::make_pair("i32", "2147483648"),
+                          std::make_pair("i32", "-2147483649"),
+                          std::make_pair("u32", "4294967296"),
+                          std::make_pair("u32", "-1"),
+                          std::make_pair("u64", "18446744073709551616"),
+                          std::make_pair("i64", "1.0"),
+                          std::make_pair("i64", "1e3"),
+                          std::make_pair("i64", "01"),
+                          std::make_pair("f64", "1e400"),
+                          std::make_pair("f32", "1e39"),
+                          std::make_pair("f64", "1."),
+                          std::make_pair("f64", ".5"),
+                          std::make_pair("f64", "+1"),
+                          std::make_pair("f64", "\"1\"")}) {
+    EXPECT_THROW(numbers().from_json(numbers_with(bad.first, bad.second), value),
+                 jpc::parse_error)
+        << bad.first << ": " << bad.second;
+  }  // for
+  numbers().from_json(numbers_with("u32", "-0"), value);
+  EXPECT_EQ(0u, value.u32);
+}
+
+TEST(FromJson, Errors) {
+  Bar bar{};
+  EXPECT_EQ(0, error_offset(Bar::full(), "", bar));
+  EXPECT_EQ(0, error_offset(Bar::full(), "[]", bar));
+  EXPECT_EQ(5, error_offset(Bar::full(), R"({"x":tru,"y":1})", bar));
+  EXPECT_EQ(16, error_offset(Bar::full(), R"({"x":true,"y":1}})", bar));
+  EXPECT_EQ(15, error_offset(Bar::full(), R"({"x":true,"y":1)", bar));
+  EXPECT_EQ(10, error_offset(Bar::full(), R"({"x":true})", bar));
+  EXPECT_EQ(14, error_offset(Bar::full(), R"({"x":true,"y":"1"})", bar));
+  try {
+    Bar::full().from_json(R"({"y":1})", bar);
+    FAIL();
+  } catch (const jpc::parse_error &error) {
+    EXPECT_STREQ("missing field \"x\" at offset 7", error.what());
+  }  // try
+}
+
+TEST(FromJson, Validate) {
+  for (const Foo &foo : {full_foo(), sparse_foo()}) {
+    EXPECT_EQ(0u, Foo::full().validate_json(jpc::to_string(Foo::full().json(foo))).skipped);
+  }  // for
+  EXPECT_EQ(9u, Bar::full().validate_json(R"({"x":true,"u":[1,2],"y":1})").skipped);
+  // Nothing is kept, so escapes in `string_view`s need no arena.
+  names().validate_json(R"({"first":"a\nb","last":"c"})");
+
+  // The same first error at the same offset as `from_json`.
+  Bar bar{};
+  for (std::string bad : {"", "[]", R"({"x":tru,"y":1})", R"({"x":true,"y":1}})",
+                          R"({"x":true,"y":1)", R"({"x":true})", R"({"y":1})",
+                          R"({"x":true,"y":"1"})", R"({"x":true,"y":1.5})",
+                          R"({"x":true,"y":1,"z":"\q"})",
+                          R"({"x":true,"y":1,"z":"\ud800"})",
+                          R"({"x":true,"y":1,"z":7})",
+                          R"({"x":true,"y":99999999999999999999})"}) {
+    std::string expected =
+        error_message([&] { Bar::full().from_json(bad, bar); });
+    EXPECT_NE("", expected) << bad;
+    EXPECT_EQ(expected, error_message([&] { Bar::full().validate_json(bad); }));
+  }  // for
+  Numbers numbers_value{};
+  for (std::string bad : {numbers_with("i32", "2147483648"),
+                          numbers_with("u32", "-1"),
+                          numbers_with("u64", "18446744073709551616"),
+                          numbers_with("f32", "1e39"),
+                          numbers_with("f32", "3.5e38"),
+                          numbers_with("f64", "-17976931348623159e292"),
+                          numbers_with("f64", "1e309"),
+                          numbers_with("f64", "1.")}) {
+    std::string expected =
+        error_message([&] { numbers().from_json(bad, numbers_value); });
+    EXPECT_NE("", expected) << bad;
+    EXPECT_EQ(expected, error_message([&] { numbers().validate_json(bad); }));
+  }  // for
+  numbers().validate_json(numbers_with("f32", "3.4e38"));
+  numbers().validate_json(numbers_with("f64", "-17976931348623157e292"));
+  numbers().validate_json(numbers_with("f64", "0.0e999999999999"));
+}
+
+TEST(FromJson, SkipsUnknownKeys) {
+  const std::vector<std::string> unknown = {
+      R"("a":{"b":[1,{"c":"]}\"{"}],"d":null})",
+      R"("e" : [ [], {}, "[" ])",
+      R"("f":-1.5e3)",
+      R"("g":true)",
+      R"("h":"\\")"};
+  std::string text = "{";
+  std::size_t skipped = 0;
+  for (const std::string &member : unknown) {
+    text += member + " ,";
+    skipped += member.size();
+  }  // for
+  text += R"("x":true,"y":7,"i":false})";
+  skipped += 9;
+  Bar bar{};
+  EXPECT_EQ(skipped, Bar::full().from_json(text, bar).skipped);
+  EXPECT_TRUE(bar.x_);
+  EXPECT_EQ(7, bar.y_);
+  EXPECT_EQ(0u, Bar::full().from_json(R"({"x":true,"y":7})", bar).skipped);
+  EXPECT_EQ(7u, Bar::full().from_json(R"({"x":true,"y":7,"w":[1]})", bar).skipped);
+}
+
+TEST(FromJson, SkipsOnlyValidJson) {
+  // What is skipped is checked as strictly as what is read, the same way
+  // by `from_json` and `validate_json`.
+  const std::vector<std::pair<std::string, std::string>> bad = {
+      {std::string(R"({"x":true,"y":1,"w":)") + '\0' + "}",
+       "expected a value at offset 20"},
+      {R"({"x":true,"y":1,"unknown": nope})", "invalid literal at offset 27"},
+      {R"({"x":true,"y":1,"w":tru})", "invalid literal at offset 20"},
+      {R"({"x":true,"y": d1})", "expected a number at offset 15"},
+      {R"({"x":true,"y":1, "u": dd5})", "expected a value at offset 22"},
+      {R"({"x":true,"y":1,"w":-})", "expected a number at offset 21"},
+      {R"({"x":true,"y":1,"w":[1.]})", "expected a digit at offset 23"},
+      {R"({"x":true,"y":1,"w":[1,2})", "expected ']' at offset 24"},
+      {R"({"x":true,"y":1,"w":{"a":1]})", "expected '}' at offset 26"},
+      {R"({"x":true,"y":1,"w":[{]})", "expected a string at offset 22"},
+      {R"({"x":true,"y":1,"w":[1 2]})", "expected ']' at offset 23"},
+      {R"({"x":true,"y":1,"w":[1,]})", "expected a value at offset 23"},
+      {R"({"x":true,"y":1,"w":{"a" 1}})", "expected ':' at offset 25"},
+      {R"({"x":true,"y":1,"w":{1:2}})", "expected a string at offset 21"},
+      {R"({"x":true,"y":1,"w":"\q"})", "invalid escape at offset 22"},
+      {R"({"x":true,"y":1,"w":"open})", "unterminated string at offset 26"},
+      {R"({"x":true,"y":1,"w":})", "expected a value at offset 20"},
+      {R"({"x":true,"y":1,"w":{"a":"\)", "unterminated string at offset 27"}};
+  for (const auto &test : bad) {
+    const std::string &text = test.first;
+    auto error = [&](bool validate) {
+      Bar bar{};
+      return error_message([&] {
+        if (validate) {
+          Bar::full().validate_json(text);
+        } else {
+          Bar::full().from_json(text, bar);
+        }  // if
+      });
+    };
+    for (bool validate : {false, true}) {
+      EXPECT_EQ(test.second, error(validate)) << text << ' ' << validate;
+    }  // for
+  }  // for
+  // Deeper than one word of brackets, and back out.
+  const std::string deep = std::string(100, '[') + std::string(100, ']');
+  Bar bar{};
+  EXPECT_EQ(deep.size() + 4,
+            Bar::full().validate_json(R"({"x":true,"y":1,"w":)" + deep + "}").skipped);
+  EXPECT_THROW(Bar::full().from_json(R"({"x":true,"y":1,"w":)" + std::string(70, '[') +
+                                         std::string(69, ']') + "}]}",
+                                     bar),
+               jpc::parse_error);
+}
+
+TEST(FromJson, StringView) {
+  // Without escapes, both views point into the input.
+  const std::string text = R"({"first":"Ada","last":"Lovelace"})";
+  Names value;
+  names().from_json(text, value);
+  EXPECT_EQ("Ada", value.first);
+  EXPECT_EQ("Lovelace", value.last);
+  EXPECT_EQ(text.data() + 10, value.first.data());
+  EXPECT_EQ(text.data() + 23, value.last.data());
+  EXPECT_EQ(text, jpc::to_string(names().json(value)));
+
+  // Escapes need an arena, which only they go to.
+  const std::string escaped = R"({"first":"A\"da","last":"Love\u006cace"})";
+  try {
+    names().from_json(escaped, value);
+    FAIL();
+  } catch (const jpc::parse_error &error) {
+    EXPECT_EQ(9u, error.offset());
+  }  // try
+  jpc::string_arena arena;
+  names().from_json(escaped, value, arena);
+  EXPECT_EQ("A\"da", value.first);
+  EXPECT_EQ("Lovelace", value.last);
+  EXPECT_EQ(2u, arena.size());
+  EXPECT_EQ(R"({"first":"A\"da","last":"Lovelace"})",
+            jpc::to_string(names().json(value)));
+  names().from_json(text, value, arena);
+  EXPECT_EQ(2u, arena.size());
+  EXPECT_EQ(text.data() + 10, value.first.data());
+}
+
+TEST(FromJson, JsonLines) {
+  std::vector<Bar> bars;
+  for (int64_t i = 0; i < 5000; ++i) {
+    bars.push_back(Bar{i % 2 == 0, i, i % 3 ? boost::none
+                                            : boost::make_optional(std::to_string(i))});
+  }  // for
+  std::string text;
+  {
+    jpc::string_writer writer(text);
+    jpc::json_lines(Bar::full(), bars.begin(), bars.end(), writer);
+  }
+  const std::string expected = text;
+  // Blank lines, CRLF and a last line without a newline are all fine.
+  text.insert(0, "\n  \n");
+  text.insert(text.find('\n', text.size() / 2), "\r");
+  text.pop_back();
+  for (std::size_t threads : {1, 2, 3, 8}) {
+    std::vector<Bar> out = {Bar{}};
+    jpc::parse_json_lines(Bar::full(), text, out, jpc::parallel(threads, 64));
+    ASSERT_EQ(bars.size(), out.size()) << threads;
+    std::string actual;
+    {
+      jpc::string_writer writer(actual);
+      jpc::json_lines(Bar::full(), out.begin(), out.end(), writer);
+    }
+    EXPECT_EQ(expected, actual) << threads;
+  }  // for
+
+  std::vector<Bar> out;
+  jpc::parse_json_lines(Bar::full(), "", out);
+  EXPECT_TRUE(out.empty());
+  jpc::parse_json_lines(Bar::full(), "\n\n", out);
+  EXPECT_TRUE(out.empty());
+
+  // Of several bad lines, the first is reported, whichever task gets to
+  // its own first.
+  std::string bad = expected;
+  std::size_t line_3001 = 0;
+  for (int i = 0; i < 3000; ++i) {
+    line_3001 = bad.find('\n', line_3001) + 1;
+  }  // for
+  bad.insert(line_3001 + 5, "x");
+  bad.insert(bad.size() - 3, "y");
+  for (std::size_t threads : {1, 4}) {
+    try {
+      jpc::parse_json_lines(Bar::full(), bad, out, jpc::parallel(threads, 64));
+      FAIL() << threads;
+    } catch (const jpc::parse_error &error) {
+      EXPECT_EQ(3001u, error.line());
+      EXPECT_EQ(line_3001 + 5, error.offset());
+      EXPECT_STREQ(("expected a boolean on line 3001 at offset " +
+                    std::to_string(line_3001 + 5)).c_str(),
+                   error.what());
+    }  // try
+  }  // for
+}
+
+TEST(FromJson, PerfectHash) {
+  using jpc::detail::perfect_hash;
+  std::vector<std::string> names = {"", "a", "b", "ab", "ba", "key",
+                                    "a_rather_long_field_name_1",
+                                    "a_rather_long_field_name_2"};
+  for (int i = 0; i < 200; ++i) {
+    names.push_back("key_" + std::to_string(i));
+  }  // for
+  std::vector<std::pair<const char *, std::size_t>> keys;
+  for (const std::string &name : names) {
+    keys.emplace_back(name.data(), name.size());
+  }  // for
+  perfect_hash hash(keys);
+  for (std::size_t i = 0; i < names.size(); ++i) {
+    EXPECT_EQ(i, hash.find(names[i].data(), names[i].size())) << names[i];
+  }  // for
+  for (std::string other : {"c", "k", "ke", "keyy", "key_200",
+                                   "key_-1", "a_rather_long_field_name_3",
+                                   "a_rather_long_field_name_"}) {
+    EXPECT_TRUE(hash.find(other.data(), other.size()) == perfect_hash::npos)
+        << other;
+  }  // for
+  EXPECT_TRUE(perfect_hash().find("a", 1) == perfect_hash::npos);
+  keys.emplace_back("key", 3);
+  EXPECT_THROW(perfect_hash{keys}, std::runtime_error);
+}
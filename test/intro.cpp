@@ -1,3 +1,9 @@
+#include <fstream>
+#include <iterator>
+
+#include <stdlib.h>
+#include <unistd.h>
+
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
 
@@ -5,116 +11,11 @@
 
 #include <google/protobuf/message.h>
 
+#include "intro.hpp"
 #include "intro.pb.h"
 
 #include <gtest/gtest.h>
 
-namespace intro {
-
-  class Bar {
-    public:
-    static const auto &full() {
-      static const auto schema = jpc::object<Bar, BarInfo>(
-          jpc::field(jpc::boolean              , &Bar::x_, "x"),
-          jpc::field(jpc::number               , &Bar::y_, "y"),
-          jpc::field(jpc::optional(jpc::string), &Bar::z_, "z")
-      )
-      .json(jpc::cpp)
-      .protobuf(jpc::cpp);
-      return schema;
-    }
-
-    bool x_;
-    int64_t y_;
-    boost::optional<std::string> z_;
-  };
-
-  class Foo {
-    public:
-    static const auto &full() {
-      static const auto schema = jpc::object<Foo, FooInfo>(
-          jpc::field(jpc::boolean              , &Foo::a_, "a"),
-          jpc::field(jpc::number               , &Foo::b_, "b"),
-          jpc::field(jpc::number               , &Foo::c_, "c"),
-          jpc::field(jpc::number               , &Foo::d_, "d"),
-          jpc::field(jpc::number               , &Foo::e_, "e"),
-          jpc::field(jpc::number               , &Foo::f_, "f"),
-          jpc::field(jpc::number               , &Foo::g_, "g"),
-          jpc::field(jpc::enumeration          , &Foo::h_, "h"),
-          jpc::field(jpc::string               , &Foo::i, "i" ),
-          jpc::field(jpc::array(jpc::number)   , &Foo::j_, "j"),
-          jpc::field(jpc::array(jpc::string)   , &Foo::k_, "k"),
-          jpc::field(jpc::optional(jpc::number), &Foo::l_, "l"),
-          jpc::field(jpc::optional(jpc::number), &Foo::m_, "m"),
-          jpc::field(jpc::number               , &Foo::n_, "n"),
-          jpc::field(jpc::optional(jpc::number), &Foo::o_, "o"),
-          jpc::field(jpc::optional(jpc::number), &Foo::p_, "p"),
-          jpc::field(Bar::full(),                &Foo::bar_, "bar")
-      )
-      .json(jpc::cpp)
-      .protobuf(jpc::cpp);
-      return schema;
-    }
-
-    Foo(bool a,
-        int32_t b,
-        int64_t c,
-        uint32_t d,
-        uint64_t e,
-        double f,
-        float g,
-        FooInfo::H h,
-        std::string i,
-        std::vector<int32_t> j,
-        std::set<std::string> k,
-        boost::optional<int32_t> l,
-        boost::optional<int32_t> m,
-        int64_t n,
-        std::unique_ptr<int32_t> o,
-        std::unique_ptr<int32_t> p,
-        Bar bar)
-        : a_(std::move(a)),
-          b_(std::move(b)),
-          c_(std::move(c)),
-          d_(std::move(d)),
-          e_(std::move(e)),
-          f_(std::move(f)),
-          g_(std::move(g)),
-          h_(std::move(h)),
-          i_(std::move(i)),
-          j_(std::move(j)),
-          k_(std::move(k)),
-          l_(std::move(l)),
-          m_(std::move(m)),
-          n_(std::move(n)),
-          o_(std::move(o)),
-          p_(std::move(p)),
-          bar_(std::move(bar)) {}
-
-    const std::string &i() const { return i_; }
-
-    private:
-    bool a_;
-    int32_t b_;
-    int64_t c_;
-    uint32_t d_;
-    uint64_t e_;
-    double f_;
-    float g_;
-    FooInfo::H h_;
-    std::string i_;
-    std::vector<int32_t> j_;
-    std::set<std::string> k_;
-    boost::optional<int32_t> l_;
-    boost::optional<int32_t> m_;
-    int64_t n_;
-    std::unique_ptr<int32_t> o_;
-    std::unique_ptr<int32_t> p_;
-    Bar bar_;
-  };
-
-}  // namespace intro
-
 using namespace intro;
 
 TEST(JPC, Intro) {
@@ -206,3 +107,279 @@ TEST(JPC, Intro) {
         strm.str());
   }
 }
+
+TEST(JPC, GeneratedAccessors) {
+  const Foo foo = full_foo();
+  FooInfo expected = Foo::full().protobuf(foo);
+  FooInfo actual = Foo::generated().protobuf(foo);
+  EXPECT_EQ(expected.SerializeAsString(), actual.SerializeAsString());
+  EXPECT_TRUE(actual.has_l());
+  EXPECT_FALSE(actual.has_m());
+  EXPECT_FALSE(actual.has_p());
+  EXPECT_EQ("bar", actual.bar().z());
+  EXPECT_FALSE(Bar::generated().protobuf(Bar{true, 1, boost::none}).has_z());
+}
+
+TEST(JPC, Writers) {
+  Bar bar{true, -7, std::string("seven")};
+  const std::string expected = R"~~({"x":true,"y":-7,"z":"seven"})~~";
+  {
+    // json::string => jpc::buffer
+    jpc::buffer buffer;
+    Bar::full().json(bar).write(buffer);
+    EXPECT_EQ(expected, buffer.str());
+    buffer.clear();
+    Bar::full().json(bar).write(buffer);
+    EXPECT_EQ(expected, buffer.str());
+  }
+  {
+    // json::string => std::string
+    std::string str = "prefix:";
+    {
+      jpc::string_writer writer(str);
+      Bar::full().json(bar).write(writer);
+    }
+    EXPECT_EQ("prefix:" + expected, str);
+    EXPECT_EQ(expected, jpc::to_string(Bar::full().json(bar)));
+  }
+  {
+    // json::string => user-supplied sink, across block boundaries.
+    std::string str;
+    std::size_t blocks = 0;
+    auto sink = [&](const char *s, std::size_t n) {
+      EXPECT_LE(n, 64u);
+      str.append(s, n);
+      ++blocks;
+    };
+    {
+      jpc::sink_writer<decltype(sink), 64> writer(sink);
+      for (int i = 0; i < 10; ++i) {
+        Bar::full().json(bar).write(writer);
+      }  // for
+    }
+    std::string repeated;
+    for (int i = 0; i < 10; ++i) {
+      repeated += expected;
+    }  // for
+    EXPECT_EQ(repeated, str);
+    EXPECT_LT(1u, blocks);
+  }
+}
+
+TEST(JPC, JsonSize) {
+  Bar bar{true, -7, std::string("say \"seven\"")};
+  const Foo foo = full_foo();
+  {
+    std::string json = jpc::to_string(Bar::full().json(bar));
+    EXPECT_EQ(json.size(), Bar::full().json_size(bar));
+  }
+  {
+    // Write into a slot of exactly `json_size` bytes.
+    std::string json = jpc::to_string(Foo::full().json(foo));
+    std::size_t size = Foo::full().json_size(foo);
+    EXPECT_EQ(json.size(), size);
+    std::unique_ptr<char[]> slot(new char[size]);
+    jpc::span_writer writer(slot.get(), size);
+    Foo::full().json(foo).write(writer);
+    EXPECT_EQ(json, std::string(writer.data(), writer.size()));
+  }
+  {
+    // One byte short.
+    std::size_t size = Foo::full().json_size(foo) - 1;
+    std::unique_ptr<char[]> slot(new char[size]);
+    jpc::span_writer writer(slot.get(), size);
+    EXPECT_THROW(Foo::full().json(foo).write(writer), std::runtime_error);
+  }
+}
+
+namespace {
+
+  /* Schemas of bounded types only. */
+
+  struct Point {
+    static const auto &full() {
+      static const auto schema = jpc::object<Point, BarInfo>(
+          jpc::field(jpc::boolean, &Point::x_, "x"),
+          jpc::field(jpc::number , &Point::y_, "y")
+      );
+      return schema;
+    }
+
+    bool x_;
+    int64_t y_;
+  };
+
+  struct Sample {
+    static const auto &full() {
+      static const auto schema = jpc::object<Sample, FooInfo>(
+          jpc::field(jpc::boolean              , &Sample::a_, "a"),
+          jpc::field(jpc::number               , &Sample::b_, "b"),
+          jpc::field(jpc::number               , &Sample::c_, "c"),
+          jpc::field(jpc::number               , &Sample::d_, "d"),
+          jpc::field(jpc::number               , &Sample::e_, "e"),
+          jpc::field(jpc::number               , &Sample::f_, "f"),
+          jpc::field(jpc::number               , &Sample::g_, "g"),
+          jpc::field(jpc::enumeration          , &Sample::h_, "h"),
+          jpc::field(jpc::optional(jpc::number), &Sample::l_, "l"),
+          jpc::field(Point::full()             , &Sample::point_, "point")
+      );
+      return schema;
+    }
+
+    bool a_;
+    int32_t b_;
+    int64_t c_;
+    uint32_t d_;
+    uint64_t e_;
+    double f_;
+    float g_;
+    FooInfo::H h_;
+    boost::optional<int32_t> l_;
+    Point point_;
+  };
+
+}  // namespace
+
+TEST(JPC, MaxJsonSize) {
+  static_assert(jpc::max_json_size<decltype(Point::full())> ==
+                    sizeof(R"~~({"x":false,"y":-9223372036854775808})~~") - 1,
+                "");
+  constexpr std::size_t max_size = jpc::max_json_size<decltype(Sample::full())>;
+  // The longest value of every field.
+  using H = std::underlying_type_t<FooInfo::H>;
+  Sample longest{false,
+                 std::numeric_limits<int32_t>::min(),
+                 std::numeric_limits<int64_t>::min(),
+                 std::numeric_limits<uint32_t>::max(),
+                 std::numeric_limits<uint64_t>::max(),
+                 -1.2345678901234567e-6,
+                 -1e20f,
+                 static_cast<FooInfo::H>(std::is_signed<H>{}
+                                             ? std::numeric_limits<H>::min()
+                                             : std::numeric_limits<H>::max()),
+                 std::numeric_limits<int32_t>::min(),
+                 {false, std::numeric_limits<int64_t>::min()}};
+  std::array<char, max_size> buffer;
+  std::size_t size = Sample::full().json_to(longest, buffer);
+  EXPECT_EQ(max_size, size);
+  EXPECT_EQ(jpc::to_string(Sample::full().json(longest)),
+            std::string(buffer.data(), size));
+
+  Sample sample{true, 1, 2, 3u, 4u, 0.5, 0.25f, FooInfo::X, boost::none,
+                {true, 42}};
+  size = Sample::full().json_to(sample, buffer);
+  EXPECT_EQ(R"~~({"a":true,"b":1,"c":2,"d":3,"e":4,"f":0.5,"g":0.25,)~~"
+            R"~~("h":1,"l":null,"point":{"x":true,"y":42}})~~",
+            std::string(buffer.data(), size));
+}
+
+TEST(JPC, Streaming) {
+  std::vector<Bar> bars;
+  for (int64_t i = 0; i < 100000; ++i) {
+    bars.push_back({i % 2 == 0,
+                    i,
+                    i % 3 == 0 ? boost::none
+                               : boost::make_optional(std::string(
+                                     static_cast<std::size_t>(i % 5000), 'z'))});
+  }  // for
+  const auto schema = jpc::array(Bar::full());
+  const std::string expected = jpc::to_string(schema.json(bars));
+  {
+    // Chunks handed to a callback never exceed the chunk size.
+    std::string actual;
+    std::size_t max_chunk = 0;
+    auto sink = [&](const char *s, std::size_t n) {
+      max_chunk = std::max(max_chunk, n);
+      actual.append(s, n);
+    };
+    {
+      jpc::sink_writer<decltype(sink), 4096> writer(sink);
+      schema.json(bars).write(writer);
+    }
+    EXPECT_EQ(expected, actual);
+    EXPECT_LE(max_chunk, 4096u);
+  }
+  {
+    // A file in /tmp, through a 4 KiB chunk.
+    char path[] = "/tmp/jpc_streaming_XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_NE(-1, fd);
+    {
+      jpc::fd_writer writer(fd, 4096);
+      schema.json(bars).write(writer);
+      writer.flush();
+    }
+    ::close(fd);
+    std::ifstream file(path, std::ios::binary);
+    std::string actual((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+    ::unlink(path);
+    EXPECT_EQ(expected, actual);
+  }
+}
+
+TEST(JPC, JsonLines) {
+  std::vector<Bar> bars = {{true, 1, boost::none},
+                           {false, 2, std::string("two")},
+                           {true, 3, std::string("line\nbreak")}};
+  const std::string expected = R"~~({"x":true,"y":1,"z":null})~~" "\n"
+                               R"~~({"x":false,"y":2,"z":"two"})~~" "\n"
+                               R"~~({"x":true,"y":3,"z":"line\nbreak"})~~" "\n";
+  {
+    jpc::buffer buffer;
+    jpc::json_lines(Bar::full(), bars.begin(), bars.end(), buffer);
+    EXPECT_EQ(expected, buffer.str());
+  }
+  {
+    std::string actual;
+    std::size_t flushes = 0;
+    jpc::json_lines(Bar::full(), bars.begin(), bars.end(),
+                    [&](const char *s, std::size_t n) {
+                      actual.append(s, n);
+                      ++flushes;
+                    });
+    EXPECT_EQ(expected, actual);
+    EXPECT_EQ(1u, flushes);
+  }
+}
+
+TEST(JPC, Parallel) {
+  std::vector<Bar> bars;
+  for (int64_t i = 0; i < 20000; ++i) {
+    bars.push_back({i % 2 == 0,
+                    i,
+                    i % 3 == 0 ? boost::none
+                               : boost::make_optional(std::to_string(i))});
+  }  // for
+  const auto schema = jpc::array(Bar::full());
+  for (std::size_t threads : {1, 2, 3, 8}) {
+    // One policy, and so one set of threads, for every write.
+    const jpc::parallel policy(threads, 100);
+    for (std::size_t n : {0, 1, 999, 1000, 1001, 20000}) {
+      auto first = bars.begin(), last = bars.begin() + static_cast<std::ptrdiff_t>(n);
+      const std::string expected = jpc::to_string(schema.json(first, last));
+      jpc::buffer buffer;
+      schema.json(first, last).write(buffer, policy);
+      EXPECT_EQ(expected, buffer.str()) << n << " elements, " << threads
+                                        << " threads";
+    }  // for
+  }  // for
+  {
+    // The buffers go to a file in one gathered write.
+    const std::string expected = jpc::to_string(schema.json(bars));
+    char path[] = "/tmp/jpc_parallel_XXXXXX";
+    int fd = ::mkstemp(path);
+    ASSERT_NE(-1, fd);
+    {
+      jpc::fd_writer writer(fd, 4096);
+      schema.json(bars).write(writer, jpc::parallel(4, 100));
+      writer.flush();
+    }
+    ::close(fd);
+    std::ifstream file(path, std::ios::binary);
+    std::string actual((std::istreambuf_iterator<char>(file)),
+                       std::istreambuf_iterator<char>());
+    ::unlink(path);
+    EXPECT_EQ(expected, actual);
+  }
+}
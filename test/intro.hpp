@@ -0,0 +1,214 @@
+#ifndef INTRO_HPP
+#define INTRO_HPP
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+
+#include <jpc.hpp>
+
+#include "intro.pb.h"
+
+namespace intro {
+
+  class Bar {
+    public:
+    static const auto &full() {
+      static const auto schema = jpc::object<Bar, BarInfo>(
+          jpc::field(jpc::boolean              , &Bar::x_, "x"),
+          jpc::field(jpc::number               , &Bar::y_, "y"),
+          jpc::field(jpc::optional(jpc::string), &Bar::z_, "z")
+      )
+      .json(jpc::cpp)
+      .protobuf(jpc::cpp);
+      return schema;
+    }
+
+    /* As `full`, but setting `BarInfo` through its generated accessors. */
+    static const auto &generated() {
+      static const auto schema = jpc::object<Bar, BarInfo>(
+          jpc::field(jpc::boolean              , &Bar::x_, "x", &BarInfo::set_x),
+          jpc::field(jpc::number               , &Bar::y_, "y", &BarInfo::set_y),
+          jpc::field(jpc::optional(jpc::string), &Bar::z_, "z", &BarInfo::mutable_z)
+      )
+      .json(jpc::cpp)
+      .protobuf(jpc::cpp);
+      return schema;
+    }
+
+    bool x_;
+    int64_t y_;
+    boost::optional<std::string> z_;
+  };
+
+  class Foo {
+    /* The schema of every field, with `i` read through `i`: `full` and
+       `assignable` differ only there. */
+    template <typename I>
+    static auto make_schema(I i) {
+      return jpc::object<Foo, FooInfo>(
+          jpc::field(jpc::boolean              , &Foo::a_, "a"),
+          jpc::field(jpc::number               , &Foo::b_, "b"),
+          jpc::field(jpc::number               , &Foo::c_, "c"),
+          jpc::field(jpc::number               , &Foo::d_, "d"),
+          jpc::field(jpc::number               , &Foo::e_, "e"),
+          jpc::field(jpc::number               , &Foo::f_, "f"),
+          jpc::field(jpc::number               , &Foo::g_, "g"),
+          jpc::field(jpc::enumeration          , &Foo::h_, "h"),
+          jpc::field(jpc::string               , i       , "i"),
+          jpc::field(jpc::array(jpc::number)   , &Foo::j_, "j"),
+          jpc::field(jpc::array(jpc::string)   , &Foo::k_, "k"),
+          jpc::field(jpc::optional(jpc::number), &Foo::l_, "l"),
+          jpc::field(jpc::optional(jpc::number), &Foo::m_, "m"),
+          jpc::field(jpc::number               , &Foo::n_, "n"),
+          jpc::field(jpc::optional(jpc::number), &Foo::o_, "o"),
+          jpc::field(jpc::optional(jpc::number), &Foo::p_, "p"),
+          jpc::field(Bar::full(),                &Foo::bar_, "bar")
+      )
+      .json(jpc::cpp)
+      .protobuf(jpc::cpp);
+    }
+
+    public:
+    static const auto &full() {
+      static const auto schema = make_schema(&Foo::i);
+      return schema;
+    }
+
+    static const auto &generated() {
+      static const auto schema = jpc::object<Foo, FooInfo>(
+          jpc::field(jpc::boolean              , &Foo::a_, "a", &FooInfo::set_a),
+          jpc::field(jpc::number               , &Foo::b_, "b", &FooInfo::set_b),
+          jpc::field(jpc::number               , &Foo::c_, "c", &FooInfo::set_c),
+          jpc::field(jpc::number               , &Foo::d_, "d", &FooInfo::set_d),
+          jpc::field(jpc::number               , &Foo::e_, "e", &FooInfo::set_e),
+          jpc::field(jpc::number               , &Foo::f_, "f", &FooInfo::set_f),
+          jpc::field(jpc::number               , &Foo::g_, "g", &FooInfo::set_g),
+          jpc::field(jpc::enumeration          , &Foo::h_, "h", &FooInfo::set_h),
+          jpc::field(jpc::string               , &Foo::i, "i" , &FooInfo::mutable_i),
+          jpc::field(jpc::array(jpc::number)   , &Foo::j_, "j", &FooInfo::mutable_j),
+          jpc::field(jpc::array(jpc::string)   , &Foo::k_, "k", &FooInfo::mutable_k),
+          jpc::field(jpc::optional(jpc::number), &Foo::l_, "l", &FooInfo::set_l),
+          jpc::field(jpc::optional(jpc::number), &Foo::m_, "m", &FooInfo::set_m),
+          jpc::field(jpc::number               , &Foo::n_, "n", &FooInfo::set_n),
+          jpc::field(jpc::optional(jpc::number), &Foo::o_, "o", &FooInfo::set_o),
+          jpc::field(jpc::optional(jpc::number), &Foo::p_, "p", &FooInfo::set_p),
+          jpc::field(Bar::generated(),           &Foo::bar_, "bar", &FooInfo::mutable_bar)
+      )
+      .json(jpc::cpp)
+      .protobuf(jpc::cpp);
+      return schema;
+    }
+
+    /* As `full`, but naming the `i_` member rather than the `i()` getter,
+       so that parsing has something to assign to. */
+    static const auto &assignable() {
+      static const auto schema = make_schema(&Foo::i_);
+      return schema;
+    }
+
+    Foo(bool a,
+        int32_t b,
+        int64_t c,
+        uint32_t d,
+        uint64_t e,
+        double f,
+        float g,
+        FooInfo::H h,
+        std::string i,
+        std::vector<int32_t> j,
+        std::set<std::string> k,
+        boost::optional<int32_t> l,
+        boost::optional<int32_t> m,
+        int64_t n,
+        std::unique_ptr<int32_t> o,
+        std::unique_ptr<int32_t> p,
+        Bar bar)
+        : a_(std::move(a)),
+          b_(std::move(b)),
+          c_(std::move(c)),
+          d_(std::move(d)),
+          e_(std::move(e)),
+          f_(std::move(f)),
+          g_(std::move(g)),
+          h_(std::move(h)),
+          i_(std::move(i)),
+          j_(std::move(j)),
+          k_(std::move(k)),
+          l_(std::move(l)),
+          m_(std::move(m)),
+          n_(std::move(n)),
+          o_(std::move(o)),
+          p_(std::move(p)),
+          bar_(std::move(bar)) {}
+
+    const std::string &i() const { return i_; }
+
+    private:
+    bool a_;
+    int32_t b_;
+    int64_t c_;
+    uint32_t d_;
+    uint64_t e_;
+    double f_;
+    float g_;
+    FooInfo::H h_;
+    std::string i_;
+    std::vector<int32_t> j_;
+    std::set<std::string> k_;
+    boost::optional<int32_t> l_;
+    boost::optional<int32_t> m_;
+    int64_t n_;
+    std::unique_ptr<int32_t> o_;
+    std::unique_ptr<int32_t> p_;
+    Bar bar_;
+  };
+
+  /* A `Foo` with every field set: escapes, extremes, negatives, and a
+     string long enough to need a two-byte length. */
+  inline Foo full_foo() {
+    return Foo(true,
+               -101,
+               std::numeric_limits<int64_t>::min(),
+               std::numeric_limits<uint32_t>::max(),
+               std::numeric_limits<uint64_t>::max(),
+               0.1,
+               -2.2f,
+               FooInfo::X,
+               "hello \"world\"\n\xc3\xa9 {[,]}" + std::string(200, 'i'),
+               {1, -2, 300},
+               {"hello", "world"},
+               505,
+               boost::none,
+               -606,
+               std::make_unique<int32_t>(707),
+               nullptr,
+               Bar{false, 42, std::string("bar")});
+  }
+
+  /* A `Foo` with every field zero, empty or absent. */
+  inline Foo sparse_foo() {
+    return Foo(false, 0, 0, 0, 0, 0, 0, FooInfo::Y, "", {}, {},
+               boost::none, boost::none, 0, nullptr, nullptr,
+               Bar{true, -1, boost::none});
+  }
+
+  /* The message of the `parse_error` that `f` throws, or "". */
+  template <typename F>
+  std::string error_message(F f) {
+    try {
+      f();
+    } catch (const jpc::parse_error &error) {
+      return error.what();
+    }  // try
+    return "";
+  }
+
+}  // namespace intro
+
+#endif  // INTRO_HPP
@@ -0,0 +1,44 @@
+#ifndef NESTED_HPP
+#define NESTED_HPP
+
+#include <vector>
+
+#include <jpc.hpp>
+
+#include "intro.hpp"
+#include "nested.pb.h"
+
+namespace intro {
+
+  /* `Foo`s two levels further down, for nested messages on the wire. */
+  class Baz {
+    public:
+    static const auto &full() {
+      static const auto schema = jpc::object<Baz, BazInfo>(
+          jpc::field(jpc::array(Foo::full()), &Baz::foos_, "foos")
+      )
+      .json(jpc::cpp)
+      .protobuf(jpc::cpp);
+      return schema;
+    }
+
+    std::vector<Foo> foos_;
+  };
+
+  class Qux {
+    public:
+    static const auto &full() {
+      static const auto schema = jpc::object<Qux, QuxInfo>(
+          jpc::field(jpc::array(Baz::full()), &Qux::bazs_, "bazs")
+      )
+      .json(jpc::cpp)
+      .protobuf(jpc::cpp);
+      return schema;
+    }
+
+    std::vector<Baz> bazs_;
+  };
+
+}  // namespace intro
+
+#endif  // NESTED_HPP
@@ -0,0 +1,308 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <jpc.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  template <typename T>
+  std::string json(T value) {
+    return jpc::to_string(jpc::number.json(value));
+  }
+
+  template <typename Float, typename Bits>
+  Float from_bits(Bits bits) {
+    Float result;
+    std::memcpy(&result, &bits, sizeof(result));
+    return result;
+  }
+
+  template <typename Float>
+  void expect_round_trip(Float value) {
+    std::string str = json(value);
+    Float result = std::is_same<Float, float>{}
+                       ? std::strtof(str.c_str(), nullptr)
+                       : std::strtod(str.c_str(), nullptr);
+    EXPECT_EQ(0, std::memcmp(&value, &result, sizeof(value)))
+        << str << " does not round-trip";
+    EXPECT_LE(str.size(), jpc::detail::dtoa::max_length);
+    EXPECT_EQ(str.size(), jpc::number.json_size(value));
+  }
+
+  /* Our parse of a JSON number against `strtod`/`strtof`, bit for bit. */
+  template <typename Float>
+  void expect_parse(const std::string &str) {
+    Float result =
+        jpc::detail::atof::to_float<Float>(str.data(), str.data() + str.size());
+    Float expected = std::is_same<Float, float>{}
+                         ? std::strtof(str.c_str(), nullptr)
+                         : std::strtod(str.c_str(), nullptr);
+    ASSERT_EQ(0, std::memcmp(&expected, &result, sizeof(result)))
+        << str << ": " << result << " != " << expected;
+  }
+
+  template <typename Float>
+  void expect_parse_all(const std::vector<std::string> &strs) {
+    for (const std::string &str : strs) {
+      expect_parse<Float>(str);
+      expect_parse<Float>('-' + str);
+    }  // for
+  }
+
+  /* Random JSON numbers: up to `max_digits` digits, the decimal point
+     anywhere, and an exponent near `exponent`. */
+  template <typename Gen>
+  std::string random_number(Gen &gen, int max_digits, int exponent) {
+    std::string digits;
+    int n = 1 + static_cast<int>(gen() % static_cast<unsigned>(max_digits));
+    for (int i = 0; i < n; ++i) {
+      digits += static_cast<char>('0' + gen() % 10);
+    }  // for
+    digits.erase(0, std::min(digits.find_first_not_of('0'), digits.size() - 1));
+    std::size_t point = gen() % (digits.size() + 1);
+    if (point != 0 && point != digits.size()) {
+      digits.insert(point, ".");
+    }  // if
+    int e = exponent + static_cast<int>(gen() % 41) - 20;
+    return e ? digits + 'e' + std::to_string(e) : digits;
+  }
+
+}  // namespace
+
+TEST(Number, ParseDoubleHardCases) {
+  expect_parse_all<double>({
+      "0", "0.0", "1", "0.1", "0.3", "3.141592653589793", "1e23", "1e22",
+      "9007199254740992", "9007199254740993", "9007199254740995",
+      "9007199254740993.0000000000000000000000000001",
+      "9007199254740992.9999999999999999999999999999",
+      "2.2250738585072011e-308", "2.2250738585072012e-308",
+      "2.2250738585072014e-308", "4.9406564584124654e-324",
+      "2.4703282292062327e-324", "2.4703282292062328e-324",
+      "2.47032822920623272088284396434110686182529901307162382212792841250337"
+      "753635104375932649918180817996189898282347722858865463328355177969898"
+      "199387398005390939063150356595155702263922908583924491051844359318028"
+      "499365361525003193704576782492193656236698636584807570015857692699037"
+      "063119282795585513329278343384093519780155312465972635795746227664652"
+      "728272200563740064854999770965994704540208281662262378573934507363390"
+      "079677619305775067401763246736009689513405355374585166611342237666786"
+      "041621596804619144672918403005300575308490487653917113865916462395249"
+      "126236538818796362393732804238910186723484976682350898633885879256283"
+      "027559956575244555072551893136908362547791869486679949683240497058210"
+      "285131854513962138377228261454376934125320985913276672363281249e-324",
+      "1.7976931348623157e308", "1.7976931348623158e308",
+      "1.7976931348623159e308", "1e308", "1e309", "1e-400", "1e400",
+      "0.000000000000000000000000000000000000000000001e-280",
+      "123456789012345678901234567890e-40", "7.2057594037927933e16",
+      "4.35679845e-20", "8.98846567431158e307", "5e-324", "1e-323",
+      "0.0000000000000000000000000000000000000000000000000000000001",
+      "18446744073709551615", "18446744073709551616", "1e-5", "1E5",
+      "1e+5", "100000000000000000000000e-3", "0e400"});
+}
+
+TEST(Number, ParseFloatHardCases) {
+  expect_parse_all<float>({
+      "0", "1", "0.1", "16777216", "16777217", "16777219",
+      "1.00000005960464477539062499", "1.000000059604644775390625",
+      "1.00000005960464477539062501", "3.4028234663852886e38",
+      "3.4028235677973366e38", "3.4028236e38", "1.1754943508e-38",
+      "1.4012984643e-45", "7.0064923216e-46", "7.0064923217e-46", "1e-50",
+      "1e39", "3.14159265358979323846", "7.038531e-26"});
+}
+
+TEST(Number, ParseDoubleDifferential) {
+  std::mt19937_64 gen(20151106);
+  // Every finite double's shortest digits, and random digit strings across
+  // the whole range, long ones included.
+  for (int i = 0; i < 300000; ++i) {
+    double value = std::abs(from_bits<double>(gen()));
+    if (std::isfinite(value)) {
+      expect_parse<double>(json(value));
+    }  // if
+  }  // for
+  for (int i = 0; i < 300000; ++i) {
+    int exponent = static_cast<int>(gen() % 700) - 350;
+    expect_parse<double>(random_number(gen, i % 10 ? 20 : 60, exponent));
+  }  // for
+}
+
+TEST(Number, ParseFloatDifferential) {
+  std::mt19937_64 gen(20151106);
+  for (int i = 0; i < 300000; ++i) {
+    float value = std::abs(from_bits<float>(static_cast<uint32_t>(gen())));
+    if (std::isfinite(value)) {
+      expect_parse<float>(json(value));
+    }  // if
+  }  // for
+  for (int i = 0; i < 300000; ++i) {
+    int exponent = static_cast<int>(gen() % 100) - 50;
+    expect_parse<float>(random_number(gen, i % 10 ? 12 : 40, exponent));
+  }  // for
+}
+
+TEST(Number, Double) {
+  EXPECT_EQ("0", json(0.0));
+  EXPECT_EQ("-0", json(-0.0));
+  EXPECT_EQ("1", json(1.0));
+  EXPECT_EQ("-1.5", json(-1.5));
+  EXPECT_EQ("1.1", json(1.1));
+  EXPECT_EQ("0.1", json(0.1));
+  EXPECT_EQ("0.30000000000000004", json(0.1 + 0.2));
+  EXPECT_EQ("123456789012345680000", json(123456789012345678901.0));
+  EXPECT_EQ("1e+21", json(1e21));
+  EXPECT_EQ("0.000001", json(1e-6));
+  EXPECT_EQ("1e-7", json(1e-7));
+  EXPECT_EQ("1.7976931348623157e+308",
+            json(std::numeric_limits<double>::max()));
+  EXPECT_EQ("2.2250738585072014e-308",
+            json(std::numeric_limits<double>::min()));
+  EXPECT_EQ("5e-324", json(std::numeric_limits<double>::denorm_min()));
+}
+
+TEST(Number, Float) {
+  EXPECT_EQ("2.2", json(2.2f));
+  EXPECT_EQ("0.1", json(0.1f));
+  EXPECT_EQ("16777216", json(16777216.0f));
+  EXPECT_EQ("3.4028235e+38", json(std::numeric_limits<float>::max()));
+  EXPECT_EQ("1e-45", json(std::numeric_limits<float>::denorm_min()));
+}
+
+TEST(Number, NonFinite) {
+  EXPECT_EQ(4u, jpc::number.json_size(std::numeric_limits<double>::quiet_NaN()));
+  EXPECT_EQ("null", json(std::numeric_limits<double>::quiet_NaN()));
+  EXPECT_EQ("null", json(std::numeric_limits<double>::infinity()));
+  EXPECT_EQ("null", json(-std::numeric_limits<double>::infinity()));
+  EXPECT_EQ("null", json(std::numeric_limits<float>::quiet_NaN()));
+  EXPECT_EQ("null", json(-std::numeric_limits<float>::infinity()));
+}
+
+TEST(Number, DoubleRoundTrip) {
+  std::mt19937_64 gen(20151106);
+  for (int i = 0; i < 1000000; ++i) {
+    double value = from_bits<double>(gen());
+    if (std::isfinite(value)) {
+      expect_round_trip(value);
+    }  // if
+  }  // for
+  std::uniform_real_distribution<double> dist(-1e6, 1e6);
+  for (int i = 0; i < 100000; ++i) {
+    expect_round_trip(dist(gen));
+  }  // for
+}
+
+TEST(Number, FloatRoundTrip) {
+  std::mt19937 gen(20151106);
+  for (int i = 0; i < 1000000; ++i) {
+    float value = from_bits<float>(static_cast<uint32_t>(gen()));
+    if (std::isfinite(value)) {
+      expect_round_trip(value);
+    }  // if
+  }  // for
+}
+
+TEST(Number, Integers) {
+  EXPECT_EQ("0", json(int32_t{0}));
+  EXPECT_EQ("-1", json(int32_t{-1}));
+  EXPECT_EQ("2147483647", json(std::numeric_limits<int32_t>::max()));
+  EXPECT_EQ("-2147483648", json(std::numeric_limits<int32_t>::min()));
+  EXPECT_EQ("4294967295", json(std::numeric_limits<uint32_t>::max()));
+  EXPECT_EQ("9223372036854775807", json(std::numeric_limits<int64_t>::max()));
+  EXPECT_EQ("-9223372036854775808", json(std::numeric_limits<int64_t>::min()));
+  EXPECT_EQ("18446744073709551615", json(std::numeric_limits<uint64_t>::max()));
+  EXPECT_EQ("4294967296", json(uint64_t{4294967296}));
+  EXPECT_EQ("100000000000000001", json(uint64_t{100000000000000001}));
+  EXPECT_EQ("-100000000", json(int64_t{-100000000}));
+}
+
+TEST(Number, Integers64) {
+  // Every power of ten, its neighbours, and random values across all widths.
+  uint64_t pow10 = 1;
+  for (int i = 0; i < 20; ++i, pow10 *= 10) {
+    for (uint64_t value : {pow10 - 1, pow10, pow10 + 1}) {
+      EXPECT_EQ(std::to_string(value), json(value));
+      EXPECT_EQ(std::to_string(static_cast<int64_t>(value)),
+                json(static_cast<int64_t>(value)));
+      EXPECT_EQ(std::to_string(-static_cast<int64_t>(value)),
+                json(-static_cast<int64_t>(value)));
+    }  // for
+  }  // for
+  std::mt19937_64 gen(20151106);
+  for (int i = 0; i < 1000000; ++i) {
+    uint64_t value = gen() >> (gen() % 64);
+    ASSERT_EQ(std::to_string(value), json(value));
+    ASSERT_EQ(std::to_string(static_cast<int64_t>(value)),
+              json(static_cast<int64_t>(value)));
+    ASSERT_EQ(std::to_string(value).size(), jpc::number.json_size(value));
+    ASSERT_EQ(std::to_string(static_cast<int64_t>(value)).size(),
+              jpc::number.json_size(static_cast<int64_t>(value)));
+  }  // for
+}
+
+TEST(Number, Integers32) {
+  // Every value below 2^20, every power of ten and its neighbours, the top
+  // of the range, and a stride through the rest, signed and unsigned.
+  using jpc::detail::itoa::to_chars;
+  const auto check = [](uint32_t value) {
+    char actual[jpc::detail::itoa::max_length];
+    ASSERT_EQ(std::to_string(value), std::string(actual, to_chars(actual, value)));
+    int32_t negative = static_cast<int32_t>(0u - value);
+    ASSERT_EQ(std::to_string(negative), std::string(actual, to_chars(actual, negative)));
+  };
+  for (uint32_t value = 0; value < (1u << 20); ++value) {
+    check(value);
+  }  // for
+  for (uint32_t pow10 = 10; pow10 <= 1000000000u; pow10 *= 10) {
+    check(pow10 - 1);
+    check(pow10);
+    check(pow10 + 1);
+  }  // for
+  for (uint32_t i = 0; i < 1000; ++i) {
+    check(std::numeric_limits<uint32_t>::max() - i);
+  }  // for
+  for (uint64_t value = 1u << 20; value <= std::numeric_limits<uint32_t>::max();
+       value += 4093) {
+    check(static_cast<uint32_t>(value));
+  }  // for
+}
+
+/* The full sweep takes minutes; run it with --gtest_also_run_disabled_tests
+   after changing the kernel. */
+TEST(Number, DISABLED_Integers32Exhaustive) {
+  // Compares every 32-bit value against a decimal odometer. The signed
+  // overloads share this kernel, so they are only sampled.
+  using jpc::detail::itoa::to_chars;
+  char expected[16] = "0";
+  std::size_t size = 1;
+  char actual[jpc::detail::itoa::max_length];
+  uint32_t value = 0;
+  do {
+    char *last = to_chars(actual, value);
+    if (last != actual + size || std::memcmp(expected, actual, size) != 0) {
+      FAIL() << value;
+    }  // if
+    if ((value & 0xFFFu) == 0) {
+      int32_t negative = static_cast<int32_t>(0u - value);
+      last = to_chars(actual, negative);
+      ASSERT_EQ(std::to_string(negative),
+                std::string(actual, static_cast<std::size_t>(last - actual)));
+    }  // if
+    std::size_t i = size;
+    while (i > 0 && expected[i - 1] == '9') {
+      expected[--i] = '0';
+    }  // while
+    if (i == 0) {
+      expected[size++] = '0';
+      expected[0] = '1';
+    } else {
+      ++expected[i - 1];
+    }  // if
+  } while (++value != 0);
+}
@@ -0,0 +1,133 @@
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/utility/string_view.hpp>
+
+#include <jpc.hpp>
+
+#include "intro.hpp"
+#include "intro.pb.h"
+
+#include <gtest/gtest.h>
+
+using namespace intro;
+
+namespace {
+
+  /* Feeds `text` in the pieces that `cuts` separate. */
+  template <typename Parser>
+  void feed(Parser &parser, const std::string &text, std::vector<std::size_t> cuts) {
+    cuts.push_back(text.size());
+    std::size_t from = 0;
+    for (std::size_t cut : cuts) {
+      parser.feed(text.data() + from, text.data() + cut);
+      from = cut;
+    }  // for
+    parser.finish();
+  }
+
+  /* The `parse_error` message for `text` fed in `cuts`, or "". */
+  std::string error(const std::string &text, std::vector<std::size_t> cuts) {
+    Bar bar{};
+    auto parser = Bar::full().parser(bar);
+    return error_message([&] { feed(parser, text, std::move(cuts)); });
+  }
+
+}  // namespace
+
+TEST(PushParser, EveryBoundary) {
+  const std::string text =
+      " \n" + jpc::to_string(Foo::full().json(full_foo())) + " \t";
+  const std::string expected = jpc::to_string(Foo::full().json(full_foo()));
+  for (std::size_t i = 0; i <= text.size(); ++i) {
+    for (std::size_t j = i; j <= text.size(); j += 7) {
+      Foo foo = sparse_foo();
+      auto parser = Foo::assignable().parser(foo);
+      feed(parser, text, {i, j});
+      ASSERT_TRUE(parser.done());
+      ASSERT_EQ(expected, jpc::to_string(Foo::full().json(foo))) << i << ' ' << j;
+    }  // for
+  }  // for
+}
+
+TEST(PushParser, ByteAtATime) {
+  const std::string text = jpc::to_string(Foo::full().json(full_foo()));
+  Foo foo = sparse_foo();
+  auto parser = Foo::assignable().parser(foo);
+  std::vector<std::size_t> cuts;
+  for (std::size_t i = 1; i < text.size(); ++i) {
+    cuts.push_back(i);
+  }  // for
+  feed(parser, text, cuts);
+  EXPECT_EQ(text, jpc::to_string(Foo::full().json(foo)));
+}
+
+TEST(PushParser, FillsAsMembersComplete) {
+  Bar bar{false, 0, boost::none};
+  auto parser = Bar::full().parser(bar);
+  parser.feed(R"({"y":12)");
+  EXPECT_EQ(0, bar.y_);
+  parser.feed(R"(3,"unknown":[{"a":"]"}],"x":tr)");
+  EXPECT_EQ(123, bar.y_);
+  EXPECT_FALSE(bar.x_);
+  parser.feed("ue}");
+  EXPECT_TRUE(bar.x_);
+  EXPECT_TRUE(parser.done());
+  parser.finish();
+}
+
+TEST(PushParser, Array) {
+  const auto schema = jpc::array(Bar::full());
+  std::string text = "[";
+  for (int i = 0; i < 50; ++i) {
+    text += jpc::to_string(Bar::full().json(Bar{i % 2 == 0, i, boost::none})) + ",";
+  }  // for
+  text.back() = ']';
+  for (std::size_t i = 0; i <= text.size(); ++i) {
+    std::vector<Bar> bars = {Bar{}};
+    auto parser = schema.parser(bars);
+    feed(parser, text, {i});
+    ASSERT_EQ(text, jpc::to_string(schema.json(bars))) << i;
+  }  // for
+  std::vector<Bar> bars = {Bar{}};
+  auto parser = schema.parser(bars);
+  feed(parser, " [ ] ", {2});
+  EXPECT_TRUE(bars.empty());
+}
+
+TEST(PushParser, StringView) {
+  struct Name {
+    boost::string_view value;
+  };
+  const auto schema = jpc::object<Name, google::protobuf::Message>(
+      jpc::field(jpc::string_view, &Name::value, "value"));
+  Name name;
+  {
+    auto parser = schema.parser(name);
+    EXPECT_THROW(parser.feed(R"({"value":"x"})"), jpc::parse_error);
+  }
+  jpc::string_arena arena;
+  auto parser = schema.parser(name, arena);
+  std::string chunk = R"({"value":"a\tb"})";
+  feed(parser, chunk, {12});
+  chunk.assign(chunk.size(), ' ');
+  EXPECT_EQ("a\tb", name.value);
+}
+
+TEST(PushParser, Errors) {
+  // Offsets are into the whole input, wherever it is cut.
+  for (std::size_t i = 0; i < 12; ++i) {
+    EXPECT_EQ("expected '{' at offset 1", error(" [", {i % 2}));
+    EXPECT_EQ("invalid literal at offset 5", error(R"({"x":tru,"y":1})", {i}));
+    EXPECT_EQ("trailing characters at offset 16", error(R"({"x":true,"y":1}})", {i}));
+    EXPECT_EQ("unterminated value at offset 15", error(R"({"x":true,"y":1)", {i}));
+    EXPECT_EQ("missing field \"y\" at offset 10", error(R"({"x":true})", {i}));
+    EXPECT_EQ("expected a string at offset 16", error(R"({"x":true,"y":1,})", {i}));
+    EXPECT_EQ("expected '}' at offset 15", error(R"({"x":true,"y":1])", {i}));
+    EXPECT_EQ("trailing characters at offset 7", error(R"({"y":1 2,"x":true})", {i}));
+  }  // for
+  EXPECT_EQ("expected '{' at offset 0", error("", {}));
+}
@@ -0,0 +1,99 @@
+#include <string>
+#include <vector>
+
+#include <jpc.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  std::string json(const std::string &value) {
+    return jpc::to_string(jpc::string.json(value));
+  }
+
+  /* Every scanner that can run on this machine. */
+  std::vector<jpc::detail::escape::find_fn> scanners() {
+    std::vector<jpc::detail::escape::find_fn> result = {
+        jpc::detail::escape::find_scalar};
+#if JPC_X86
+    result.push_back(jpc::detail::escape::find_sse2);
+    if (__builtin_cpu_supports("avx2")) {
+      result.push_back(jpc::detail::escape::find_avx2);
+    }  // if
+#endif
+    return result;
+  }
+
+}  // namespace
+
+TEST(String, Escape) {
+  EXPECT_EQ(2u, jpc::string.json_size(""));
+  EXPECT_EQ(13u, jpc::string.json_size(std::string("a\"\n\x01", 4)));
+  EXPECT_EQ(R"~~("")~~", json(""));
+  EXPECT_EQ(R"~~("hello")~~", json("hello"));
+  EXPECT_EQ(R"~~("say \"hi\"")~~", json("say \"hi\""));
+  EXPECT_EQ(R"~~("C:\\dir\\file")~~", json("C:\\dir\\file"));
+  EXPECT_EQ(R"~~("\b\f\n\r\t")~~", json("\b\f\n\r\t"));
+  EXPECT_EQ(R"~~("\u0000\u0001\u001f")~~", json(std::string("\0\x01\x1f", 3)));
+  EXPECT_EQ("\"\x7f\"", json("\x7f"));
+  EXPECT_EQ("\"caf\xc3\xa9\"", json("caf\xc3\xa9"));
+}
+
+TEST(String, EscapeKeys) {
+  struct Quoted {
+    int32_t x;
+  };
+  static const auto schema = jpc::object<Quoted, google::protobuf::Message>(
+      jpc::field(jpc::number, &Quoted::x, "a\"b"));
+  EXPECT_EQ(R"~~({"a\"b":1})~~", jpc::to_string(schema.json(Quoted{1})));
+}
+
+TEST(String, Scanners) {
+  // Every byte value, at every offset across two 32-byte blocks.
+  for (auto find : scanners()) {
+    for (int c = 0; c < 256; ++c) {
+      bool escaped = c < 0x20 || c == '"' || c == '\\';
+      for (std::size_t i = 0; i < 70; ++i) {
+        std::string str(70, 'x');
+        str[i] = static_cast<char>(c);
+        const char *first = str.data();
+        const char *last = first + str.size();
+        EXPECT_EQ(escaped ? first + i : last, find(first, last))
+            << "byte " << c << " at " << i;
+        EXPECT_EQ(first + i, find(first, first + i));
+      }  // for
+    }  // for
+  }  // for
+}
+
+TEST(String, LongStrings) {
+  std::string str, expected = "\"";
+  for (int i = 0; i < 1000; ++i) {
+    char c = static_cast<char>(i % 128);
+    str += c;
+    if (c == '"' || c == '\\') {
+      expected += '\\';
+      expected += c;
+    } else if (c == '\n') {
+      expected += "\\n";
+    } else if (c == '\t') {
+      expected += "\\t";
+    } else if (c == '\r') {
+      expected += "\\r";
+    } else if (c == '\b') {
+      expected += "\\b";
+    } else if (c == '\f') {
+      expected += "\\f";
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      static constexpr char hex[] = "0123456789abcdef";
+      expected += "\\u00";
+      expected += hex[c >> 4];
+      expected += hex[c & 0xF];
+    } else {
+      expected += c;
+    }  // if
+  }  // for
+  expected += '"';
+  EXPECT_EQ(expected, json(str));
+  EXPECT_EQ(expected.size(), jpc::string.json_size(str));
+}
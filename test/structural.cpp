@@ -0,0 +1,143 @@
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <jpc.hpp>
+
+#include <gtest/gtest.h>
+
+namespace {
+
+  namespace structural = jpc::detail::structural;
+
+  /* Byte by byte, as the spec reads. */
+  std::vector<uint32_t> reference(const std::string &text) {
+    std::vector<uint32_t> result;
+    bool in_string = false, escaped = false, scalar = false;
+    for (std::size_t i = 0; i < text.size(); ++i) {
+      auto c = static_cast<unsigned char>(text[i]);
+      if (in_string) {
+        if (escaped) {
+          escaped = false;
+        } else if (c == '\\') {
+          escaped = true;
+        } else if (c == '"') {
+          in_string = false;
+        }  // if
+        continue;
+      }  // if
+      bool was_scalar = scalar;
+      scalar = false;
+      if (escaped) {
+        // A backslash outside a string still escapes the next byte.
+        // An escaped quote is just another scalar byte.
+        escaped = false;
+        if (structural::is_op(c)) {
+          result.push_back(static_cast<uint32_t>(i));
+        } else if (!structural::is_ws(c)) {
+          scalar = true;
+          if (!was_scalar) {
+            result.push_back(static_cast<uint32_t>(i));
+          }  // if
+        }  // if
+        continue;
+      }  // if
+      if (c == '"') {
+        in_string = true;
+        result.push_back(static_cast<uint32_t>(i));
+      } else if (structural::is_op(c)) {
+        result.push_back(static_cast<uint32_t>(i));
+      } else if (!structural::is_ws(c)) {
+        scalar = true;
+        escaped = c == '\\';
+        if (!was_scalar) {
+          result.push_back(static_cast<uint32_t>(i));
+        }  // if
+      }  // if
+    }  // for
+    return result;
+  }
+
+  /* Block by block, through one of the kernels. */
+  std::vector<uint32_t> starts(structural::classify_fn classify, const std::string &text) {
+    std::vector<uint32_t> result;
+    structural::carry carry;
+    for (std::size_t i = 0; i < text.size(); i += 64) {
+      char block[64];
+      std::memset(block, ' ', sizeof(block));
+      text.copy(block, sizeof(block), i);
+      uint64_t bits = structural::find(classify(block), carry);
+      for (; bits; bits &= bits - 1) {
+        result.push_back(static_cast<uint32_t>(i) +
+                         static_cast<uint32_t>(__builtin_ctzll(bits)));
+      }  // for
+    }  // for
+    return result;
+  }
+
+  /* Every kernel that can run on this machine. */
+  std::vector<structural::classify_fn> kernels() {
+    std::vector<structural::classify_fn> result = {structural::classify_scalar};
+#if JPC_X86
+    if (__builtin_cpu_supports("sse4.2")) {
+      result.push_back(structural::classify_sse42);
+    }  // if
+    if (__builtin_cpu_supports("avx2")) {
+      result.push_back(structural::classify_avx2);
+    }  // if
+#endif
+    return result;
+  }
+
+}  // namespace
+
+TEST(Structural, Starts) {
+  std::string text = R"( {"a\"b" : [1, -2.5e3,true] ,"c\\":"{,}"} )";
+  const std::vector<uint32_t> offsets = starts(structural::select_classify(), text);
+  std::string tokens;
+  for (uint32_t i : offsets) {
+    tokens += text[i];
+  }  // for
+  EXPECT_EQ(R"({":[1,-,t],":"})", tokens);
+  EXPECT_EQ(reference(text), offsets);
+}
+
+TEST(Structural, Kernels) {
+  // Random soup of the bytes that matter, across block boundaries, with
+  // long backslash runs.
+  const std::string alphabet = "{}[]:,\"\\\\\\  \t\n\rab1-\x01\xff";
+  std::mt19937 gen(42);
+  std::uniform_int_distribution<std::size_t> pick(0, alphabet.size() - 1);
+  for (std::size_t size : {0, 1, 63, 64, 65, 127, 128, 129, 1000, 4096}) {
+    for (int round = 0; round < 50; ++round) {
+      std::string text;
+      for (std::size_t i = 0; i < size; ++i) {
+        text += alphabet[pick(gen)];
+      }  // for
+      const std::vector<uint32_t> expected = reference(text);
+      for (auto classify : kernels()) {
+        ASSERT_EQ(expected, starts(classify, text)) << size << ": " << text;
+      }  // for
+    }  // for
+  }  // for
+}
+
+TEST(Structural, Classify) {
+  // Every byte value in every lane, against the scalar classifier.
+  char block[64];
+  for (int first = 0; first < 256; ++first) {
+    for (int i = 0; i < 64; ++i) {
+      block[i] = static_cast<char>(first + i);
+    }  // for
+    const structural::masks expected = structural::classify_scalar(block);
+    for (auto classify : kernels()) {
+      const structural::masks masks = classify(block);
+      EXPECT_EQ(expected.quote, masks.quote) << first;
+      EXPECT_EQ(expected.backslash, masks.backslash) << first;
+      EXPECT_EQ(expected.op, masks.op) << first;
+      EXPECT_EQ(expected.ws, masks.ws) << first;
+    }  // for
+  }  // for
+}
@@ -0,0 +1,344 @@
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <boost/optional.hpp>
+#include <boost/optional/optional_io.hpp>
+
+#include <jpc.hpp>
+
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl_lite.h>
+#include <google/protobuf/wire_format_lite.h>
+
+#include "intro.hpp"
+#include "intro.pb.h"
+#include "nested.hpp"
+
+#include <gtest/gtest.h>
+
+using namespace intro;
+
+using google::protobuf::internal::WireFormatLite;
+using google::protobuf::io::CodedOutputStream;
+using google::protobuf::io::StringOutputStream;
+
+namespace {
+
+  /* What protobuf itself writes, given a way to write the values. */
+  template <typename F>
+  std::string coded(F f) {
+    std::string result;
+    {
+      StringOutputStream output(&result);
+      CodedOutputStream stream(&output);
+      f(stream);
+    }
+    return result;
+  }
+
+  template <typename Schema, typename T>
+  std::string encode(const Schema &schema, const jpc::detail::wire::field &field, const T &value) {
+    jpc::detail::wire::sizes sizes;
+    const std::size_t size = schema.wire_size(field, value, sizes);
+    std::string result;
+    {
+      jpc::string_writer writer(result);
+      schema.write_wire(writer, field, value, sizes);
+    }
+    EXPECT_EQ(size, result.size());
+    return result;
+  }
+
+}  // namespace
+
+TEST(Wire, ParsesBack) {
+  for (auto make : {&full_foo, &sparse_foo}) {
+    const Foo foo = make();
+    const std::string bytes = Foo::full().protobuf_bytes(foo);
+    FooInfo info;
+    ASSERT_TRUE(info.ParseFromString(bytes));
+    const FooInfo expected = Foo::full().protobuf(foo);
+    EXPECT_EQ(expected.SerializeAsString(), info.SerializeAsString());
+    EXPECT_EQ(expected.SerializeAsString().size(), bytes.size());
+    EXPECT_EQ(bytes.size(), Foo::full().protobuf_bytes_size(foo));
+  }  // for
+}
+
+/* Every nested message's length matches what is written under it, down
+   through repeated messages of messages. */
+TEST(Wire, Nested) {
+  Qux qux;
+  for (int i = 0; i < 3; ++i) {
+    Baz baz;
+    for (int j = 0; j <= i; ++j) {
+      baz.foos_.push_back(j % 2 ? sparse_foo() : full_foo());
+    }  // for
+    qux.bazs_.push_back(std::move(baz));
+  }  // for
+  qux.bazs_.emplace_back();
+  const std::string bytes = Qux::full().protobuf_bytes(qux);
+  EXPECT_EQ(bytes.size(), Qux::full().protobuf_bytes_size(qux));
+  QuxInfo expected;
+  for (const Baz &baz : qux.bazs_) {
+    BazInfo *info = expected.add_bazs();
+    for (const Foo &foo : baz.foos_) {
+      *info->add_foos() = Foo::full().protobuf(foo);
+    }  // for
+  }  // for
+  QuxInfo info;
+  ASSERT_TRUE(info.ParseFromString(bytes));
+  EXPECT_EQ(expected.SerializeAsString(), info.SerializeAsString());
+  jpc::buffer buffer(1);
+  Qux::full().protobuf_bytes(qux, buffer);
+  EXPECT_EQ(bytes, buffer.str());
+  std::string small(bytes.size(), '\0');
+  {
+    google::protobuf::io::ArrayOutputStream output(&small[0], static_cast<int>(small.size()), 7);
+    CodedOutputStream stream(&output);
+    Qux::full().protobuf_bytes(qux, stream);
+  }
+  EXPECT_EQ(bytes, small);
+}
+
+TEST(Wire, LeavesOutEmpty) {
+  FooInfo info;
+  ASSERT_TRUE(info.ParseFromString(Foo::full().protobuf_bytes(sparse_foo())));
+  EXPECT_FALSE(info.has_l());
+  EXPECT_FALSE(info.has_o());
+  EXPECT_EQ(0, info.j_size());
+  EXPECT_EQ(0, info.k_size());
+  EXPECT_TRUE(info.has_bar());
+  EXPECT_FALSE(info.bar().has_z());
+  EXPECT_EQ(-1, info.bar().y());
+}
+
+TEST(Wire, Writers) {
+  const Foo foo = full_foo();
+  const std::string expected = Foo::full().protobuf_bytes(foo);
+  {
+    jpc::buffer buffer(1);
+    Foo::full().protobuf_bytes(foo, buffer);
+    EXPECT_EQ(expected, buffer.str());
+  }
+  {
+    std::string text = "prefix";
+    {
+      jpc::string_writer writer(text);
+      Foo::full().protobuf_bytes(foo, writer);
+    }
+    EXPECT_EQ("prefix" + expected, text);
+  }
+  EXPECT_EQ(expected, coded([&](CodedOutputStream &stream) {
+              Foo::full().protobuf_bytes(foo, stream);
+            }));
+  // Blocks too small for the whole message go through a copy.
+  std::string small(expected.size(), '\0');
+  {
+    google::protobuf::io::ArrayOutputStream output(&small[0], static_cast<int>(small.size()), 7);
+    CodedOutputStream stream(&output);
+    Foo::full().protobuf_bytes(foo, stream);
+    EXPECT_FALSE(stream.HadError());
+  }
+  EXPECT_EQ(expected, small);
+}
+
+TEST(Wire, Encodings) {
+  namespace wire = jpc::detail::wire;
+  using encoding = wire::encoding;
+  const auto tag = [](int number, WireFormatLite::WireType type) {
+    return WireFormatLite::MakeTag(number, type);
+  };
+  for (int64_t value : {int64_t{0}, int64_t{1}, int64_t{-1}, int64_t{127}, int64_t{128},
+                        int64_t{-64}, int64_t{1} << 35,
+                        std::numeric_limits<int64_t>::min(),
+                        std::numeric_limits<int64_t>::max()}) {
+    const auto i32 = static_cast<int32_t>(value);
+    EXPECT_EQ(coded([&](CodedOutputStream &stream) {
+                stream.WriteTag(tag(1, WireFormatLite::WIRETYPE_VARINT));
+                stream.WriteVarint64(static_cast<uint64_t>(value));
+              }),
+              encode(jpc::number, wire::make_field(1, encoding::varint, false), value));
+    EXPECT_EQ(coded([&](CodedOutputStream &stream) {
+                stream.WriteTag(tag(2, WireFormatLite::WIRETYPE_VARINT));
+                stream.WriteVarint32SignExtended(i32);
+              }),
+              encode(jpc::number, wire::make_field(2, encoding::varint, false), i32));
+    EXPECT_EQ(coded([&](CodedOutputStream &stream) {
+                stream.WriteTag(tag(3, WireFormatLite::WIRETYPE_VARINT));
+                stream.WriteVarint64(WireFormatLite::ZigZagEncode64(value));
+              }),
+              encode(jpc::number, wire::make_field(3, encoding::zigzag, false), value));
+    EXPECT_EQ(coded([&](CodedOutputStream &stream) {
+                stream.WriteTag(tag(4, WireFormatLite::WIRETYPE_VARINT));
+                stream.WriteVarint32(WireFormatLite::ZigZagEncode32(i32));
+              }),
+              encode(jpc::number, wire::make_field(4, encoding::zigzag, false), i32));
+    EXPECT_EQ(coded([&](CodedOutputStream &stream) {
+                stream.WriteTag(tag(5, WireFormatLite::WIRETYPE_FIXED32));
+                stream.WriteLittleEndian32(static_cast<uint32_t>(i32));
+              }),
+              encode(jpc::number, wire::make_field(5, encoding::fixed32, false), i32));
+    EXPECT_EQ(coded([&](CodedOutputStream &stream) {
+                stream.WriteTag(tag(2000, WireFormatLite::WIRETYPE_FIXED64));
+                stream.WriteLittleEndian64(static_cast<uint64_t>(value));
+              }),
+              encode(jpc::number, wire::make_field(2000, encoding::fixed64, false), value));
+  }  // for
+  EXPECT_EQ(coded([&](CodedOutputStream &stream) {
+              stream.WriteTag(tag(6, WireFormatLite::WIRETYPE_FIXED32));
+              stream.WriteLittleEndian32(WireFormatLite::EncodeFloat(-2.5f));
+              stream.WriteTag(tag(7, WireFormatLite::WIRETYPE_FIXED64));
+              stream.WriteLittleEndian64(WireFormatLite::EncodeDouble(0.1));
+            }),
+            encode(jpc::number, wire::make_field(6, encoding::fixed32, false), -2.5f) +
+                encode(jpc::number, wire::make_field(7, encoding::fixed64, false), 0.1));
+}
+
+TEST(Wire, Repeated) {
+  namespace wire = jpc::detail::wire;
+  using encoding = wire::encoding;
+  const std::vector<int32_t> values = {0, -1, 1, 1000000};
+  const auto schema = jpc::array(jpc::number);
+  EXPECT_EQ(coded([&](CodedOutputStream &stream) {
+              stream.WriteTag(WireFormatLite::MakeTag(
+                  4, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+              stream.WriteVarint32(1 + 1 + 1 + 3);
+              for (int32_t value : values) {
+                stream.WriteVarint32(WireFormatLite::ZigZagEncode32(value));
+              }  // for
+            }),
+            encode(schema, wire::make_field(4, encoding::zigzag, true), values));
+  EXPECT_EQ(coded([&](CodedOutputStream &stream) {
+              for (int32_t value : values) {
+                stream.WriteTag(WireFormatLite::MakeTag(4, WireFormatLite::WIRETYPE_FIXED32));
+                stream.WriteLittleEndian32(static_cast<uint32_t>(value));
+              }  // for
+            }),
+            encode(schema, wire::make_field(4, encoding::fixed32, false), values));
+  // An empty packed field is left out altogether.
+  EXPECT_EQ("", encode(schema, wire::make_field(4, encoding::varint, true),
+                     std::vector<int32_t>{}));
+  const std::vector<Bar> bars = {Bar{true, 1, boost::none}, Bar{false, -2, std::string("z")}};
+  std::string expected;
+  for (const Bar &bar : bars) {
+    const std::string bytes = Bar::full().protobuf(bar).SerializeAsString();
+    expected += coded([&](CodedOutputStream &stream) {
+      stream.WriteTag(WireFormatLite::MakeTag(9, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+      stream.WriteVarint32(static_cast<uint32_t>(bytes.size()));
+      stream.WriteRaw(bytes.data(), static_cast<int>(bytes.size()));
+    });
+  }  // for
+  EXPECT_EQ(expected, encode(jpc::array(Bar::full()),
+                           wire::make_field(9, encoding::length_delimited, false), bars));
+}
+
+TEST(Wire, Decodes) {
+  // Each into the other, so that every member is overwritten or reset.
+  for (auto make : {&full_foo, &sparse_foo}) {
+    const Foo foo = make();
+    Foo decoded = make == &full_foo ? sparse_foo() : full_foo();
+    const auto result = Foo::assignable().from_protobuf_bytes(
+        Foo::full().protobuf(foo).SerializeAsString(), decoded);
+    EXPECT_EQ(0u, result.skipped);
+    EXPECT_EQ(jpc::to_string(Foo::full().json(foo)),
+              jpc::to_string(Foo::full().json(decoded)));
+    decoded = make == &full_foo ? sparse_foo() : full_foo();
+    Foo::assignable().from_protobuf_bytes(Foo::full().protobuf_bytes(foo), decoded);
+    EXPECT_EQ(jpc::to_string(Foo::full().json(foo)),
+              jpc::to_string(Foo::full().json(decoded)));
+  }  // for
+}
+
+/* A nested message that occurs more than once is merged, as protobuf
+   merges it, rather than read afresh. */
+TEST(Wire, MergesNested) {
+  const FooInfo first = Foo::full().protobuf(full_foo());
+  FooInfo second = Foo::full().protobuf(sparse_foo());
+  second.mutable_bar()->clear_y();
+  const std::string bytes = first.SerializeAsString() + second.SerializeAsString();
+  FooInfo expected;
+  ASSERT_TRUE(expected.ParseFromString(bytes));
+  EXPECT_EQ(42, expected.bar().y());
+  EXPECT_EQ("bar", expected.bar().z());
+  Foo decoded = sparse_foo();
+  EXPECT_EQ(0u, Foo::assignable().from_protobuf_bytes(bytes, decoded).skipped);
+  EXPECT_EQ(expected.SerializeAsString(), Foo::full().protobuf(decoded).SerializeAsString());
+}
+
+TEST(Wire, SkipsUnknown) {
+  const auto tag = [](int number, WireFormatLite::WireType type) {
+    return WireFormatLite::MakeTag(number, type);
+  };
+  const std::string bytes = coded([&](CodedOutputStream &stream) {
+    stream.WriteTag(tag(3, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+    stream.WriteVarint32(1);
+    stream.WriteRaw("z", 1);
+    stream.WriteTag(tag(50, WireFormatLite::WIRETYPE_VARINT));
+    stream.WriteVarint32(300);
+    stream.WriteTag(tag(51, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+    stream.WriteVarint32(3);
+    stream.WriteRaw("abc", 3);
+    stream.WriteTag(tag(1, WireFormatLite::WIRETYPE_VARINT));
+    stream.WriteVarint32(1);
+    stream.WriteTag(tag(52, WireFormatLite::WIRETYPE_FIXED32));
+    stream.WriteLittleEndian32(7);
+    stream.WriteTag(tag(1000, WireFormatLite::WIRETYPE_FIXED64));
+    stream.WriteLittleEndian64(7);
+  });
+  Bar bar{false, 5, boost::none};
+  EXPECT_EQ(4u + 6u + 6u + 10u, Bar::full().from_protobuf_bytes(bytes, bar).skipped);
+  EXPECT_TRUE(bar.x_);
+  EXPECT_EQ(0, bar.y_);
+  EXPECT_EQ(std::string("z"), bar.z_);
+}
+
+TEST(Wire, PackedOrNot) {
+  namespace wire = jpc::detail::wire;
+  const auto field = wire::make_field(4, wire::encoding::zigzag, true);
+  const std::string bytes = coded([&](CodedOutputStream &stream) {
+    stream.WriteTag(WireFormatLite::MakeTag(4, WireFormatLite::WIRETYPE_LENGTH_DELIMITED));
+    stream.WriteVarint32(2);
+    stream.WriteVarint32(WireFormatLite::ZigZagEncode32(-1));
+    stream.WriteVarint32(WireFormatLite::ZigZagEncode32(2));
+    stream.WriteTag(WireFormatLite::MakeTag(4, WireFormatLite::WIRETYPE_VARINT));
+    stream.WriteVarint32(WireFormatLite::ZigZagEncode32(-300));
+  });
+  std::vector<int32_t> values;
+  wire::input input(bytes.data(), bytes.data() + bytes.size());
+  while (!input.done()) {
+    uint32_t wire_type;
+    ASSERT_EQ(4u, input.read_tag(wire_type));
+    jpc::array(jpc::number).read_wire(input, field, wire_type, values);
+  }  // while
+  EXPECT_EQ((std::vector<int32_t>{-1, 2, -300}), values);
+}
+
+TEST(Wire, DecodeErrors) {
+  const auto error = [](const std::string &bytes) {
+    Bar bar{};
+    return error_message([&] { Bar::full().from_protobuf_bytes(bytes, bar); });
+  };
+  EXPECT_EQ("", error(std::string("\x08\x01", 2)));
+  EXPECT_EQ("missing field \"x\" at offset 2", error(std::string("\x10\x01", 2)));
+  EXPECT_EQ("unexpected wire type at offset 1", error(std::string("\x0a\x01x", 3)));
+  EXPECT_EQ("invalid tag at offset 1", error(std::string("\x00", 1)));
+  EXPECT_EQ("truncated message at offset 2", error(std::string("\x08\x80", 2)));
+  EXPECT_EQ("truncated message at offset 4", error(std::string("\x08\x01\x1a\x05z", 5)));
+  EXPECT_EQ("unsupported wire type at offset 1", error(std::string("\x23", 1)));
+  // Cut anywhere, the bytes are rejected just when protobuf rejects them:
+  // in the middle of a field or before the required ones.
+  const std::string bytes = Foo::full().protobuf_bytes(full_foo());
+  for (std::size_t size = 0; size < bytes.size(); ++size) {
+    const std::string prefix = bytes.substr(0, size);
+    Foo foo = full_foo();
+    FooInfo info;
+    if (info.ParsePartialFromString(prefix) && info.IsInitialized()) {
+      EXPECT_NO_THROW(Foo::assignable().from_protobuf_bytes(prefix, foo)) << size;
+    } else {
+      EXPECT_THROW(Foo::assignable().from_protobuf_bytes(prefix, foo), jpc::parse_error) << size;
+    }  // if
+  }  // for
+}